@@ -0,0 +1,137 @@
+#include "generators.hpp"
+
+#include "gdwg/algorithm.hpp"
+
+#include <benchmark/benchmark.h>
+
+// Path and reachability queries on a road-like grid and on a power-law graph: the two shapes that
+// stress long searches and hub-heavy frontiers respectively. PageRank, strongly connected
+// components and topological sorting run on the power-law graph.
+namespace {
+	constexpr auto query_count = std::size_t{64};
+
+	auto bm_shortest_path_grid(benchmark::State& state) -> void {
+		auto const side = static_cast<std::size_t>(state.range(0));
+		auto const g = bench::make_grid_graph(side);
+		auto const queries = bench::make_queries<int>(side * side, query_count);
+		auto workspace = gdwg::path_workspace<int>();
+		for (auto _ : state) {
+			for (auto const& [src, dst] : queries) {
+				benchmark::DoNotOptimize(gdwg::shortest_path(g, src, dst, workspace));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(queries.size()));
+	}
+
+	auto bm_shortest_path_power_law(benchmark::State& state) -> void {
+		auto const n = static_cast<std::size_t>(state.range(0));
+		auto const g = bench::make_power_law_graph(n, 8);
+		auto const queries = bench::make_queries<int>(n, query_count);
+		auto workspace = gdwg::path_workspace<int>();
+		for (auto _ : state) {
+			for (auto const& [src, dst] : queries) {
+				benchmark::DoNotOptimize(gdwg::shortest_path(g, src, dst, workspace));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(queries.size()));
+	}
+
+	// The same as above, but with a fresh workspace for every query.
+	auto bm_shortest_path_power_law_cold(benchmark::State& state) -> void {
+		auto const n = static_cast<std::size_t>(state.range(0));
+		auto const g = bench::make_power_law_graph(n, 8);
+		auto const queries = bench::make_queries<int>(n, query_count);
+		for (auto _ : state) {
+			for (auto const& [src, dst] : queries) {
+				benchmark::DoNotOptimize(gdwg::shortest_path(g, src, dst));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(queries.size()));
+	}
+
+	auto bm_shortest_paths_grid(benchmark::State& state) -> void {
+		auto const side = static_cast<std::size_t>(state.range(0));
+		auto const g = bench::make_grid_graph(side);
+		auto workspace = gdwg::path_workspace<int>();
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::shortest_paths(g, 0, workspace));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(side * side));
+	}
+
+	// `state.range(1)` threads search from node 0 (the biggest hub).
+	auto bm_hop_distances_power_law(benchmark::State& state) -> void {
+		auto const n = static_cast<std::size_t>(state.range(0));
+		auto const g = bench::make_power_law_graph(n, 16);
+		auto const options = gdwg::bfs_options{.threads = static_cast<unsigned>(state.range(1))};
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::hop_distances(g, 0, options));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n * 16));
+	}
+
+	auto bm_hop_distances_grid(benchmark::State& state) -> void {
+		auto const side = static_cast<std::size_t>(state.range(0));
+		auto const g = bench::make_grid_graph(side);
+		auto const options = gdwg::bfs_options{.threads = static_cast<unsigned>(state.range(1))};
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::hop_distances(g, 0, options));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(side * side));
+	}
+
+	auto bm_page_rank_power_law(benchmark::State& state) -> void {
+		auto const n = static_cast<std::size_t>(state.range(0));
+		auto const g = bench::make_power_law_graph(n, 16);
+		auto const options =
+		   gdwg::page_rank_options{.threads = static_cast<unsigned>(state.range(1))};
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::page_rank(g, options));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n * 16));
+	}
+
+	auto bm_strongly_connected_components_power_law(benchmark::State& state) -> void {
+		auto const n = static_cast<std::size_t>(state.range(0));
+		auto const g = bench::make_power_law_graph(n, 4);
+		auto workspace = gdwg::traversal_workspace();
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::strongly_connected_components(g, workspace));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n * 4));
+	}
+
+	// The power-law graph with every edge pointed from the smaller node to the larger one.
+	auto bm_topological_order_power_law(benchmark::State& state) -> void {
+		auto const n = static_cast<std::size_t>(state.range(0));
+		auto const cyclic = bench::make_power_law_graph(n, 4);
+		auto const values = cyclic.nodes();
+		auto g = gdwg::graph<int, int>(values.begin(), values.end());
+		for (auto const& [from, to, weight] : cyclic) {
+			if (from != to) {
+				g.insert_edge(std::min(from, to), std::max(from, to), weight);
+			}
+		}
+		auto workspace = gdwg::traversal_workspace();
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::topological_order(g, workspace));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n * 4));
+	}
+} // namespace
+
+BENCHMARK(bm_shortest_path_grid)->RangeMultiplier(4)->Range(1 << 4, 1 << 8);
+BENCHMARK(bm_shortest_path_power_law)->RangeMultiplier(8)->Range(1 << 8, 1 << 17);
+BENCHMARK(bm_shortest_path_power_law_cold)->RangeMultiplier(8)->Range(1 << 8, 1 << 17);
+BENCHMARK(bm_shortest_paths_grid)->RangeMultiplier(4)->Range(1 << 4, 1 << 8);
+BENCHMARK(bm_hop_distances_power_law)
+   ->Apply([](auto* b) { bench::thread_counts(b, 1 << 17); })
+   ->UseRealTime();
+BENCHMARK(bm_hop_distances_grid)
+   ->Apply([](auto* b) { bench::thread_counts(b, 1 << 9); })
+   ->UseRealTime();
+BENCHMARK(bm_strongly_connected_components_power_law)->RangeMultiplier(8)->Range(1 << 8, 1 << 17);
+BENCHMARK(bm_topological_order_power_law)->RangeMultiplier(8)->Range(1 << 8, 1 << 17);
+BENCHMARK(bm_page_rank_power_law)
+   ->Apply([](auto* b) { bench::thread_counts(b, 1 << 17); })
+   ->UseRealTime();
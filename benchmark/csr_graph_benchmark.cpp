@@ -0,0 +1,87 @@
+#include "generators.hpp"
+#include "memory.hpp"
+
+#include "gdwg/csr_graph.hpp"
+
+#include <benchmark/benchmark.h>
+
+// The same read-only queries against a `graph` and its frozen `csr_graph`, so the two can be
+// compared directly. Each benchmark also reports how much heap the structure it queries holds
+// (`heap_bytes` and `bytes_per_edge`). Cache misses need a Google Benchmark built with libpfm:
+// run with `--benchmark_perf_counters=CACHE-MISSES,INSTRUCTIONS` to add them.
+namespace {
+	constexpr auto degree = std::size_t{8};
+	constexpr auto query_count = std::size_t{1024};
+
+	auto nodes(benchmark::State const& state) -> std::size_t {
+		return static_cast<std::size_t>(state.range(0));
+	}
+
+	// A random graph as `Graph`, with the heap it holds reported on `state`. The `graph` it is
+	// made from is gone by the time it is measured.
+	template<typename Graph>
+	auto make_measured(benchmark::State& state) -> Graph {
+		auto const before = bench::heap_bytes();
+		auto g = Graph(bench::make_random_graph<int, int>(nodes(state), degree));
+		bench::report_heap_bytes(state, before, nodes(state) * degree);
+		return g;
+	}
+
+	auto bm_freeze(benchmark::State& state) -> void {
+		auto const g = bench::make_random_graph<int, int>(nodes(state), degree);
+		for (auto _ : state) {
+			auto csr = gdwg::csr_graph(g);
+			benchmark::DoNotOptimize(csr);
+		}
+	}
+
+	template<typename Graph>
+	auto bm_is_connected(benchmark::State& state) -> void {
+		auto const g = make_measured<Graph>(state);
+		auto const queries = bench::make_queries<int>(nodes(state), query_count);
+		for (auto _ : state) {
+			for (auto const& [src, dst] : queries) {
+				benchmark::DoNotOptimize(g.is_connected(src, dst));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(queries.size()));
+	}
+
+	template<typename Graph>
+	auto bm_connections(benchmark::State& state) -> void {
+		auto const g = make_measured<Graph>(state);
+		auto const queries = bench::make_queries<int>(nodes(state), query_count);
+		for (auto _ : state) {
+			for (auto const& query : queries) {
+				benchmark::DoNotOptimize(g.connections(query.first));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(queries.size()));
+	}
+
+	template<typename Graph>
+	auto bm_iterate(benchmark::State& state) -> void {
+		auto const g = make_measured<Graph>(state);
+		auto edges = std::int64_t{0};
+		for (auto _ : state) {
+			for (auto const& value : g) {
+				benchmark::DoNotOptimize(value);
+				++edges;
+			}
+		}
+		state.SetItemsProcessed(edges);
+	}
+} // namespace
+
+BENCHMARK(bm_freeze)->RangeMultiplier(8)->Range(1 << 6, 1 << 15);
+BENCHMARK_TEMPLATE(bm_is_connected, gdwg::graph<int, int>)
+   ->RangeMultiplier(8)->Range(1 << 6, 1 << 15);
+BENCHMARK_TEMPLATE(bm_is_connected, gdwg::csr_graph<int, int>)
+   ->RangeMultiplier(8)->Range(1 << 6, 1 << 15);
+BENCHMARK_TEMPLATE(bm_connections, gdwg::graph<int, int>)
+   ->RangeMultiplier(8)->Range(1 << 6, 1 << 15);
+BENCHMARK_TEMPLATE(bm_connections, gdwg::csr_graph<int, int>)
+   ->RangeMultiplier(8)->Range(1 << 6, 1 << 15);
+BENCHMARK_TEMPLATE(bm_iterate, gdwg::graph<int, int>)->RangeMultiplier(8)->Range(1 << 6, 1 << 15);
+BENCHMARK_TEMPLATE(bm_iterate, gdwg::csr_graph<int, int>)
+   ->RangeMultiplier(8)->Range(1 << 6, 1 << 15);
@@ -0,0 +1,157 @@
+#ifndef GDWG_BENCHMARK_GENERATORS_HPP
+#define GDWG_BENCHMARK_GENERATORS_HPP
+
+#include "gdwg/graph.hpp"
+
+#include <algorithm>
+#include <array>
+#include <benchmark/benchmark.h>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Inputs shared by the benchmarks. Everything is generated from a fixed seed so runs can be
+// compared with each other.
+namespace bench {
+	// A node or weight type that is expensive to copy and compare.
+	struct large {
+		std::array<std::uint64_t, 16> words;
+
+		friend auto operator<=>(large const&, large const&) = default;
+
+		friend auto operator<<(std::ostream& os, large const& value) -> std::ostream& {
+			return os << value.words.front();
+		}
+	};
+
+	template<typename T>
+	auto make_value(std::uint64_t i) -> T {
+		if constexpr (std::is_same_v<T, std::string>) {
+			// Long enough to live on the heap, and padded so string order matches numeric order.
+			auto digits = std::to_string(i);
+			return "node-" + std::string(20 - digits.size(), '0') + digits;
+		}
+		else if constexpr (std::is_same_v<T, large>) {
+			auto ret = large{};
+			ret.words.fill(i);
+			return ret;
+		}
+		else {
+			return static_cast<T>(i);
+		}
+	}
+
+	template<typename T>
+	auto make_values(std::size_t n) -> std::vector<T> {
+		auto ret = std::vector<T>();
+		ret.reserve(n);
+		for (auto i = std::size_t{0}; i < n; ++i) {
+			ret.push_back(make_value<T>(i));
+		}
+		return ret;
+	}
+
+	// `n * degree` edges between uniformly random nodes.
+	template<typename N, typename E>
+	auto make_random_edges(std::size_t n, std::size_t degree)
+	   -> std::vector<typename gdwg::graph<N, E>::value_type> {
+		auto rng = std::mt19937_64(6771);
+		auto pick = std::uniform_int_distribution<std::uint64_t>(0, n - 1);
+		auto weight = std::uniform_int_distribution<std::uint64_t>(1, 100);
+		auto ret = std::vector<typename gdwg::graph<N, E>::value_type>();
+		ret.reserve(n * degree);
+		for (auto i = std::size_t{0}; i < n * degree; ++i) {
+			auto src = make_value<N>(pick(rng));
+			auto dst = make_value<N>(pick(rng));
+			ret.push_back({std::move(src), std::move(dst), make_value<E>(weight(rng))});
+		}
+		return ret;
+	}
+
+	template<typename N, typename E>
+	auto make_random_graph(std::size_t n, std::size_t degree) -> gdwg::graph<N, E> {
+		auto const values = make_values<N>(n);
+		auto g = gdwg::graph<N, E>(values.begin(), values.end());
+		auto const edges = make_random_edges<N, E>(n, degree);
+		g.insert_edges(edges.begin(), edges.end());
+		return g;
+	}
+
+	// A `side` by `side` grid with edges both ways between neighbours: long paths and a low,
+	// even degree, like a road network.
+	inline auto make_grid_graph(std::size_t side) -> gdwg::graph<int, int> {
+		auto const n = side * side;
+		auto const values = make_values<int>(n);
+		auto g = gdwg::graph<int, int>(values.begin(), values.end());
+		auto rng = std::mt19937_64(6771);
+		auto weight = std::uniform_int_distribution<int>(1, 100);
+		auto edges = std::vector<gdwg::graph<int, int>::value_type>();
+		for (auto i = std::size_t{0}; i < n; ++i) {
+			auto const node = static_cast<int>(i);
+			if (i % side + 1 < side) {
+				edges.push_back({node, node + 1, weight(rng)});
+				edges.push_back({node + 1, node, weight(rng)});
+			}
+			if (i + side < n) {
+				edges.push_back({node, node + static_cast<int>(side), weight(rng)});
+				edges.push_back({node + static_cast<int>(side), node, weight(rng)});
+			}
+		}
+		g.insert_edges(edges.begin(), edges.end());
+		return g;
+	}
+
+	// `n * degree` edges whose endpoints follow a Zipf-like distribution, so a few hubs have most
+	// of the edges and any node is a few hops from any other.
+	inline auto make_power_law_graph(std::size_t n, std::size_t degree) -> gdwg::graph<int, int> {
+		auto const values = make_values<int>(n);
+		auto g = gdwg::graph<int, int>(values.begin(), values.end());
+		auto rng = std::mt19937_64(6771);
+		auto unit = std::uniform_real_distribution<double>(0.0, 1.0);
+		auto weight = std::uniform_int_distribution<int>(1, 100);
+		auto pick = [&] {
+			auto const u = unit(rng);
+			return static_cast<int>(static_cast<double>(n - 1) * u * u * u);
+		};
+		auto edges = std::vector<gdwg::graph<int, int>::value_type>();
+		edges.reserve(n * degree);
+		for (auto i = std::size_t{0}; i < n * degree; ++i) {
+			edges.push_back({pick(), pick(), weight(rng)});
+		}
+		g.insert_edges(edges.begin(), edges.end());
+		return g;
+	}
+
+	// `count` random (src, dst) pairs of existing nodes to query with.
+	template<typename N>
+	auto make_queries(std::size_t n, std::size_t count) -> std::vector<std::pair<N, N>> {
+		auto rng = std::mt19937_64(1531);
+		auto pick = std::uniform_int_distribution<std::uint64_t>(0, n - 1);
+		auto ret = std::vector<std::pair<N, N>>();
+		ret.reserve(count);
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			ret.emplace_back(make_value<N>(pick(rng)), make_value<N>(pick(rng)));
+		}
+		return ret;
+	}
+
+	// Adds `{size, threads}` argument pairs to `b` for 1, 2, 4, ... threads, up to and including
+	// one per hardware thread.
+	inline auto thread_counts(benchmark::internal::Benchmark* b, std::int64_t size) -> void {
+		auto const hardware =
+		   static_cast<std::int64_t>(std::max(1U, std::thread::hardware_concurrency()));
+		for (auto threads = std::int64_t{1}; threads < hardware; threads *= 2) {
+			b->Args({size, threads});
+		}
+		b->Args({size, hardware});
+	}
+} // namespace bench
+
+#endif // GDWG_BENCHMARK_GENERATORS_HPP
@@ -0,0 +1,320 @@
+#include "generators.hpp"
+#include "memory.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Every benchmark is run over graphs of `state.range(0)` nodes with `degree` edges per node, for
+// each of the N/E pairs registered at the bottom of the file.
+namespace {
+	constexpr auto degree = std::size_t{8};
+	constexpr auto query_count = std::size_t{1024};
+
+	auto nodes(benchmark::State const& state) -> std::size_t {
+		return static_cast<std::size_t>(state.range(0));
+	}
+
+	template<typename N, typename E>
+	auto bm_insert_node(benchmark::State& state) -> void {
+		auto const values = bench::make_values<N>(nodes(state));
+		for (auto _ : state) {
+			auto g = gdwg::graph<N, E>();
+			for (auto const& value : values) {
+				g.insert_node(value);
+			}
+			benchmark::DoNotOptimize(g);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(values.size()));
+	}
+
+	// Reports the heap a graph holds: `bytes_per_node` for the nodes alone, and `bytes_per_edge`
+	// for what the edges add on top of them.
+	template<typename N, typename E>
+	auto bm_footprint(benchmark::State& state) -> void {
+		auto const values = bench::make_values<N>(nodes(state));
+		auto const edges = bench::make_random_edges<N, E>(nodes(state), degree);
+		auto node_bytes = std::size_t{0};
+		auto edge_bytes = std::size_t{0};
+		auto edge_count = std::ptrdiff_t{0};
+		for (auto _ : state) {
+			auto const before = bench::heap_bytes();
+			auto g = gdwg::graph<N, E>(values.begin(), values.end());
+			auto const with_nodes = bench::heap_bytes();
+			g.insert_edges(edges.begin(), edges.end());
+			node_bytes = with_nodes - before;
+			edge_bytes = bench::heap_bytes() - with_nodes;
+			edge_count = std::distance(g.begin(), g.end());
+			benchmark::DoNotOptimize(g);
+		}
+		state.counters["bytes_per_node"] =
+		   static_cast<double>(node_bytes) / static_cast<double>(values.size());
+		state.counters["bytes_per_edge"] =
+		   static_cast<double>(edge_bytes) / static_cast<double>(edge_count);
+	}
+
+	template<typename N, typename E>
+	auto bm_insert_edge(benchmark::State& state) -> void {
+		auto const values = bench::make_values<N>(nodes(state));
+		auto const edges = bench::make_random_edges<N, E>(nodes(state), degree);
+		for (auto _ : state) {
+			auto g = gdwg::graph<N, E>(values.begin(), values.end());
+			for (auto const& [src, dst, weight] : edges) {
+				g.insert_edge(src, dst, weight);
+			}
+			benchmark::DoNotOptimize(g);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(edges.size()));
+	}
+
+	template<typename N, typename E>
+	auto bm_insert_edges(benchmark::State& state) -> void {
+		auto const values = bench::make_values<N>(nodes(state));
+		auto const edges = bench::make_random_edges<N, E>(nodes(state), degree);
+		for (auto _ : state) {
+			auto g = gdwg::graph<N, E>(values.begin(), values.end());
+			g.insert_edges(edges.begin(), edges.end());
+			benchmark::DoNotOptimize(g);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(edges.size()));
+	}
+
+	// Erases every tenth node from a fresh copy of the graph.
+	template<typename N, typename E>
+	auto bm_erase_node(benchmark::State& state) -> void {
+		auto const g = bench::make_random_graph<N, E>(nodes(state), degree);
+		auto const values = bench::make_values<N>(nodes(state));
+		for (auto _ : state) {
+			state.PauseTiming();
+			auto copy = g;
+			state.ResumeTiming();
+			for (auto i = std::size_t{0}; i < values.size(); i += 10) {
+				copy.erase_node(values[i]);
+			}
+			benchmark::DoNotOptimize(copy);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(values.size() / 10));
+	}
+
+	// Merges every tenth node into its neighbour in a fresh copy of the graph.
+	template<typename N, typename E>
+	auto bm_merge_replace_node(benchmark::State& state) -> void {
+		auto const g = bench::make_random_graph<N, E>(nodes(state), degree);
+		auto const values = bench::make_values<N>(nodes(state));
+		for (auto _ : state) {
+			state.PauseTiming();
+			auto copy = g;
+			state.ResumeTiming();
+			for (auto i = std::size_t{0}; i + 1 < values.size(); i += 10) {
+				copy.merge_replace_node(values[i], values[i + 1]);
+			}
+			benchmark::DoNotOptimize(copy);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(values.size() / 10));
+	}
+
+	// Applies a delta that erases every tenth node and a tenth of the edges, and adds as many new
+	// edges, through one transaction on a fresh copy of the graph.
+	template<typename N, typename E>
+	auto bm_transaction(benchmark::State& state) -> void {
+		auto const g = bench::make_random_graph<N, E>(nodes(state), degree);
+		auto const values = bench::make_values<N>(nodes(state));
+		auto const erased = bench::make_random_edges<N, E>(nodes(state), 1);
+		// Edges from new nodes to old ones that survive the erasures (odd numbered).
+		auto inserted = std::vector<typename gdwg::graph<N, E>::value_type>();
+		for (auto i = std::size_t{0}; i < values.size(); ++i) {
+			inserted.push_back({bench::make_value<N>(values.size() + i),
+			                    values[(i * 10 + 1) % values.size()],
+			                    bench::make_value<E>(i)});
+		}
+		for (auto _ : state) {
+			state.PauseTiming();
+			auto copy = g;
+			state.ResumeTiming();
+			auto batch = copy.batch();
+			for (auto i = std::size_t{0}; i < values.size(); i += 10) {
+				batch.erase_node(values[i]);
+			}
+			for (auto const& [src, dst, weight] : erased) {
+				batch.erase_edge(src, dst, weight);
+			}
+			for (auto const& [src, dst, weight] : inserted) {
+				batch.insert_node(src).insert_edge(src, dst, weight);
+			}
+			batch.commit();
+			benchmark::DoNotOptimize(copy);
+		}
+		state.SetItemsProcessed(state.iterations()
+		                        * static_cast<std::int64_t>(values.size() / 10 + erased.size()
+		                                                    + inserted.size()));
+	}
+
+	template<typename N, typename E>
+	auto bm_is_connected(benchmark::State& state) -> void {
+		auto g = bench::make_random_graph<N, E>(nodes(state), degree);
+		auto const queries = bench::make_queries<N>(nodes(state), query_count);
+		for (auto _ : state) {
+			for (auto const& [src, dst] : queries) {
+				benchmark::DoNotOptimize(g.is_connected(src, dst));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(queries.size()));
+	}
+
+	// The same queries against a graph with `node_lookup::hashed`.
+	template<typename N, typename E>
+	auto bm_is_connected_hashed(benchmark::State& state) -> void {
+		auto const values = bench::make_values<N>(nodes(state));
+		auto const edges = bench::make_random_edges<N, E>(nodes(state), degree);
+		auto g = gdwg::graph<N, E>(gdwg::node_lookup::hashed);
+		for (auto const& value : values) {
+			g.insert_node(value);
+		}
+		g.insert_edges(edges.begin(), edges.end());
+		auto const queries = bench::make_queries<N>(nodes(state), query_count);
+		for (auto _ : state) {
+			for (auto const& [src, dst] : queries) {
+				benchmark::DoNotOptimize(g.is_connected(src, dst));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(queries.size()));
+	}
+
+	template<typename N, typename E>
+	auto bm_weights(benchmark::State& state) -> void {
+		auto g = bench::make_random_graph<N, E>(nodes(state), degree);
+		auto const queries = bench::make_queries<N>(nodes(state), query_count);
+		for (auto _ : state) {
+			for (auto const& [src, dst] : queries) {
+				benchmark::DoNotOptimize(g.weights(src, dst));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(queries.size()));
+	}
+
+	template<typename N, typename E>
+	auto bm_find(benchmark::State& state) -> void {
+		auto g = bench::make_random_graph<N, E>(nodes(state), degree);
+		auto const edges = bench::make_random_edges<N, E>(nodes(state), 1);
+		for (auto _ : state) {
+			for (auto const& [src, dst, weight] : edges) {
+				benchmark::DoNotOptimize(g.find(src, dst, weight));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(edges.size()));
+	}
+
+	template<typename N, typename E>
+	auto bm_connections(benchmark::State& state) -> void {
+		auto g = bench::make_random_graph<N, E>(nodes(state), degree);
+		auto const queries = bench::make_queries<N>(nodes(state), query_count);
+		for (auto _ : state) {
+			for (auto const& query : queries) {
+				benchmark::DoNotOptimize(g.connections(query.first));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(queries.size()));
+	}
+
+	template<typename N, typename E>
+	auto bm_iterate(benchmark::State& state) -> void {
+		auto const g = bench::make_random_graph<N, E>(nodes(state), degree);
+		auto edges = std::int64_t{0};
+		for (auto _ : state) {
+			for (auto const& value : g) {
+				benchmark::DoNotOptimize(value);
+				++edges;
+			}
+		}
+		state.SetItemsProcessed(edges);
+	}
+
+	template<typename N, typename E>
+	auto bm_copy(benchmark::State& state) -> void {
+		auto const g = bench::make_random_graph<N, E>(nodes(state), degree);
+		for (auto _ : state) {
+			auto copy = g;
+			benchmark::DoNotOptimize(copy);
+		}
+	}
+
+	template<typename N, typename E>
+	auto bm_move(benchmark::State& state) -> void {
+		auto g = bench::make_random_graph<N, E>(nodes(state), degree);
+		for (auto _ : state) {
+			auto moved = std::move(g);
+			benchmark::DoNotOptimize(moved);
+			g = std::move(moved);
+		}
+	}
+
+	template<typename N, typename E>
+	auto bm_output(benchmark::State& state) -> void {
+		auto const g = bench::make_random_graph<N, E>(nodes(state), degree);
+		for (auto _ : state) {
+			auto out = std::ostringstream();
+			out << g;
+			benchmark::DoNotOptimize(out.str());
+		}
+	}
+
+	template<typename N, typename E>
+	auto bm_dump(benchmark::State& state) -> void {
+		auto const g = bench::make_random_graph<N, E>(nodes(state), degree);
+		auto out = std::string();
+		for (auto _ : state) {
+			out.clear();
+			dump(g, out);
+			benchmark::DoNotOptimize(out);
+		}
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(out.size()));
+	}
+
+	// Reports the rate in bytes of text read.
+	template<typename N, typename E>
+	auto bm_read(benchmark::State& state) -> void {
+		auto out = std::ostringstream();
+		out << bench::make_random_graph<N, E>(nodes(state), degree);
+		auto const text = out.str();
+		for (auto _ : state) {
+			auto in = std::istringstream(text);
+			auto g = gdwg::read_graph<N, E>(in);
+			benchmark::DoNotOptimize(g);
+		}
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(text.size()));
+	}
+} // namespace
+
+#define GDWG_GRAPH_BENCHMARK(name)                                                                 \
+	BENCHMARK_TEMPLATE(name, int, int)->RangeMultiplier(8)->Range(1 << 6, 1 << 15);                \
+	BENCHMARK_TEMPLATE(name, std::string, std::string)->RangeMultiplier(8)->Range(1 << 6, 1 << 15); \
+	BENCHMARK_TEMPLATE(name, bench::large, int)->RangeMultiplier(8)->Range(1 << 6, 1 << 15)
+
+GDWG_GRAPH_BENCHMARK(bm_footprint);
+GDWG_GRAPH_BENCHMARK(bm_insert_node);
+GDWG_GRAPH_BENCHMARK(bm_insert_edge);
+GDWG_GRAPH_BENCHMARK(bm_insert_edges);
+GDWG_GRAPH_BENCHMARK(bm_erase_node);
+GDWG_GRAPH_BENCHMARK(bm_merge_replace_node);
+GDWG_GRAPH_BENCHMARK(bm_transaction);
+GDWG_GRAPH_BENCHMARK(bm_is_connected);
+// `bench::large` has no `std::hash`.
+BENCHMARK_TEMPLATE(bm_is_connected_hashed, int, int)->RangeMultiplier(8)->Range(1 << 6, 1 << 15);
+BENCHMARK_TEMPLATE(bm_is_connected_hashed, std::string, std::string)
+   ->RangeMultiplier(8)
+   ->Range(1 << 6, 1 << 15);
+GDWG_GRAPH_BENCHMARK(bm_weights);
+GDWG_GRAPH_BENCHMARK(bm_find);
+GDWG_GRAPH_BENCHMARK(bm_connections);
+GDWG_GRAPH_BENCHMARK(bm_iterate);
+GDWG_GRAPH_BENCHMARK(bm_copy);
+GDWG_GRAPH_BENCHMARK(bm_move);
+GDWG_GRAPH_BENCHMARK(bm_output);
+GDWG_GRAPH_BENCHMARK(bm_dump);
+// `bench::large` has no `operator>>`.
+BENCHMARK_TEMPLATE(bm_read, int, int)->RangeMultiplier(8)->Range(1 << 6, 1 << 15);
+BENCHMARK_TEMPLATE(bm_read, std::string, std::string)->RangeMultiplier(8)->Range(1 << 6, 1 << 15);
@@ -0,0 +1,96 @@
+#include "memory.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+	std::atomic<std::size_t> live_bytes = 0;
+	std::atomic<std::size_t> peak_bytes = 0;
+
+	// Every block starts with a header holding its size, so unsized deletes can be counted too.
+	// The header is as big as the strictest alignment operator new has to meet.
+	constexpr auto header = alignof(std::max_align_t);
+
+	auto allocate(std::size_t size) noexcept -> void* {
+		auto* block = static_cast<unsigned char*>(std::malloc(size + header));
+		if (block == nullptr) {
+			return nullptr;
+		}
+		*reinterpret_cast<std::size_t*>(block) = size;
+		auto const live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+		auto peak = peak_bytes.load(std::memory_order_relaxed);
+		while (live > peak && !peak_bytes.compare_exchange_weak(peak, live)) {
+		}
+		return block + header;
+	}
+
+	auto allocate_or_throw(std::size_t size) -> void* {
+		auto* p = allocate(size);
+		if (p == nullptr) {
+			throw std::bad_alloc();
+		}
+		return p;
+	}
+
+	auto deallocate(void* p) noexcept -> void {
+		if (p == nullptr) {
+			return;
+		}
+		auto* block = static_cast<unsigned char*>(p) - header;
+		live_bytes.fetch_sub(*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+		std::free(block);
+	}
+} // namespace
+
+auto bench::heap_bytes() -> std::size_t {
+	return live_bytes.load(std::memory_order_relaxed);
+}
+
+auto bench::peak_heap_bytes() -> std::size_t {
+	return peak_bytes.load(std::memory_order_relaxed);
+}
+
+auto bench::reset_peak_heap_bytes() -> void {
+	peak_bytes.store(live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+auto operator new(std::size_t size) -> void* {
+	return allocate_or_throw(size);
+}
+
+auto operator new[](std::size_t size) -> void* {
+	return allocate_or_throw(size);
+}
+
+auto operator new(std::size_t size, std::nothrow_t const&) noexcept -> void* {
+	return allocate(size);
+}
+
+auto operator new[](std::size_t size, std::nothrow_t const&) noexcept -> void* {
+	return allocate(size);
+}
+
+auto operator delete(void* p) noexcept -> void {
+	deallocate(p);
+}
+
+auto operator delete[](void* p) noexcept -> void {
+	deallocate(p);
+}
+
+auto operator delete(void* p, std::size_t) noexcept -> void {
+	deallocate(p);
+}
+
+auto operator delete[](void* p, std::size_t) noexcept -> void {
+	deallocate(p);
+}
+
+auto operator delete(void* p, std::nothrow_t const&) noexcept -> void {
+	deallocate(p);
+}
+
+auto operator delete[](void* p, std::nothrow_t const&) noexcept -> void {
+	deallocate(p);
+}
@@ -0,0 +1,27 @@
+#ifndef GDWG_BENCHMARK_MEMORY_HPP
+#define GDWG_BENCHMARK_MEMORY_HPP
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+
+// Heap accounting for the benchmarks, through a replacement of the global operator new and
+// operator delete in memory.cpp. Link `benchmark_memory` to use it.
+namespace bench {
+	// The bytes currently allocated through operator new.
+	auto heap_bytes() -> std::size_t;
+
+	// The most `heap_bytes()` has been since the last call to `reset_peak_heap_bytes()`.
+	auto peak_heap_bytes() -> std::size_t;
+	auto reset_peak_heap_bytes() -> void;
+
+	// Reports how much a structure built since `heap_bytes()` was `before` holds on the heap, in
+	// total and per edge.
+	inline auto report_heap_bytes(benchmark::State& state, std::size_t before, std::size_t edges)
+	   -> void {
+		auto const bytes = static_cast<double>(heap_bytes() - before);
+		state.counters["heap_bytes"] = bytes;
+		state.counters["bytes_per_edge"] = edges == 0 ? 0 : bytes / static_cast<double>(edges);
+	}
+} // namespace bench
+
+#endif // GDWG_BENCHMARK_MEMORY_HPP
@@ -0,0 +1,50 @@
+#include "generators.hpp"
+#include "memory.hpp"
+
+#include "gdwg/parallel_build.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <string>
+
+// Bulk edge inserts into a graph of `state.range(0)` nodes with `degree` edges per node, on
+// `state.range(1)` threads. One thread is the sequential `graph::insert_edges`. Each run also
+// reports the heap the finished graph holds per edge, and the most the build used on top of it
+// for buckets and partitions (`scratch_bytes`).
+namespace {
+	constexpr auto degree = std::size_t{16};
+
+	template<typename N, typename E>
+	auto bm_insert_edges(benchmark::State& state) -> void {
+		auto const n = static_cast<std::size_t>(state.range(0));
+		auto const values = bench::make_values<N>(n);
+		auto const edges = bench::make_random_edges<N, E>(n, degree);
+		auto const options = gdwg::build_options{.threads = static_cast<unsigned>(state.range(1))};
+		auto heap = std::size_t{0};
+		auto scratch = std::size_t{0};
+		for (auto _ : state) {
+			state.PauseTiming();
+			auto const before = bench::heap_bytes();
+			auto g = gdwg::graph<N, E>(values.begin(), values.end());
+			bench::reset_peak_heap_bytes();
+			state.ResumeTiming();
+			benchmark::DoNotOptimize(gdwg::insert_edges(g, edges.begin(), edges.end(), options));
+			state.PauseTiming();
+			heap = bench::heap_bytes() - before;
+			scratch = bench::peak_heap_bytes() - bench::heap_bytes();
+			g.clear();
+			state.ResumeTiming();
+		}
+		state.counters["bytes_per_edge"] =
+		   static_cast<double>(heap) / static_cast<double>(edges.size());
+		state.counters["scratch_bytes"] = static_cast<double>(scratch);
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(edges.size()));
+	}
+} // namespace
+
+BENCHMARK_TEMPLATE(bm_insert_edges, int, int)
+   ->Apply([](auto* b) { bench::thread_counts(b, 1 << 14); })
+   ->UseRealTime();
+BENCHMARK_TEMPLATE(bm_insert_edges, std::string, std::string)
+   ->Apply([](auto* b) { bench::thread_counts(b, 1 << 14); })
+   ->UseRealTime();
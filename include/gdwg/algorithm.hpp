@@ -0,0 +1,980 @@
+#ifndef GDWG_ALGORITHM_HPP
+#define GDWG_ALGORITHM_HPP
+
+#include "gdwg/graph.hpp"
+#include "gdwg/workers.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gdwg {
+	// A shortest path between two nodes: its total weight and every node along it, starting at
+	// the source and ending at the destination.
+	template<typename N, typename E>
+	struct path {
+		E distance;
+		std::vector<N> nodes;
+	};
+
+	// Scratch space for `shortest_paths` and `shortest_path`. Its arrays are indexed by node id and
+	// only ever grow, and they are invalidated between queries by bumping an epoch rather than by
+	// clearing them, so reusing one workspace for many queries allocates nothing once it has seen
+	// the largest graph it is used with.
+	template<typename E>
+	class path_workspace {
+	public:
+		using node_id = std::uint32_t;
+
+		// Runs Dijkstra from `src`, stopping early once `target` is settled (if one is given).
+		// Afterwards `reached()` lists every node given a distance, in the order they were reached.
+		template<typename N, typename A>
+		auto run(graph<N, E, A> const& g, node_id src, std::optional<node_id> target) -> void {
+			using access = detail::graph_access;
+			start(access::id_bound(g));
+			relax(src, E{}, src);
+
+			while (!heap_.empty()) {
+				auto const [dist, id] = pop();
+				if (dist > dist_[id]) {
+					continue;
+				}
+				if (target && id == *target) {
+					return;
+				}
+				for (auto const& edge : access::out_edges(g, id)) {
+					if (edge.weight < E{}) {
+						throw std::runtime_error("Cannot call gdwg::shortest_paths on a graph with "
+						                         "negative edge weights");
+					}
+					relax(edge.to, dist + edge.weight, id);
+				}
+			}
+		}
+
+		[[nodiscard]] auto reached() const -> std::vector<node_id> const& {
+			return reached_;
+		}
+
+		[[nodiscard]] auto is_reached(node_id id) const -> bool {
+			return id < stamp_.size() && stamp_[id] == epoch_;
+		}
+
+		[[nodiscard]] auto distance(node_id id) const -> E {
+			return dist_[id];
+		}
+
+		[[nodiscard]] auto parent(node_id id) const -> node_id {
+			return parent_[id];
+		}
+
+	private:
+		std::vector<E> dist_;
+		std::vector<node_id> parent_;
+		// `dist_[id]` and `parent_[id]` only hold this query's values if `stamp_[id] == epoch_`.
+		std::vector<std::uint32_t> stamp_;
+		std::uint32_t epoch_ = 0;
+		std::vector<node_id> reached_;
+		// A 4-ary min-heap of (distance, id) with lazy deletion: a node is pushed again whenever
+		// its distance improves, and stale entries are skipped as they are popped. Four children
+		// per level keep each sift-down within a cache line or two.
+		std::vector<std::pair<E, node_id>> heap_;
+
+		static constexpr auto arity = std::size_t{4};
+
+		auto start(std::size_t bound) -> void {
+			if (stamp_.size() < bound) {
+				dist_.resize(bound);
+				parent_.resize(bound);
+				stamp_.resize(bound, 0);
+			}
+			if (epoch_ == std::numeric_limits<std::uint32_t>::max()) {
+				std::fill(stamp_.begin(), stamp_.end(), 0);
+				epoch_ = 0;
+			}
+			++epoch_;
+			reached_.clear();
+			heap_.clear();
+		}
+
+		auto relax(node_id id, E dist, node_id parent) -> void {
+			if (stamp_[id] != epoch_) {
+				stamp_[id] = epoch_;
+				reached_.push_back(id);
+			}
+			else if (!(dist < dist_[id])) {
+				return;
+			}
+			dist_[id] = dist;
+			parent_[id] = parent;
+			push(dist, id);
+		}
+
+		auto push(E dist, node_id id) -> void {
+			heap_.emplace_back(dist, id);
+			auto i = heap_.size() - 1;
+			while (i > 0) {
+				auto const up = (i - 1) / arity;
+				if (!(heap_[i].first < heap_[up].first)) {
+					break;
+				}
+				std::swap(heap_[i], heap_[up]);
+				i = up;
+			}
+		}
+
+		auto pop() -> std::pair<E, node_id> {
+			auto const top = heap_.front();
+			heap_.front() = heap_.back();
+			heap_.pop_back();
+
+			auto i = std::size_t{0};
+			while (true) {
+				auto const first = i * arity + 1;
+				if (first >= heap_.size()) {
+					break;
+				}
+				auto best = first;
+				for (auto c = first + 1; c < std::min(first + arity, heap_.size()); ++c) {
+					if (heap_[c].first < heap_[best].first) {
+						best = c;
+					}
+				}
+				if (!(heap_[best].first < heap_[i].first)) {
+					break;
+				}
+				std::swap(heap_[i], heap_[best]);
+				i = best;
+			}
+			return top;
+		}
+	};
+
+	// The distance from `src` to every node reachable from it (including `src` itself, at
+	// distance zero), sorted by node. Edge weights must not be negative.
+	template<typename N, typename E, typename A>
+	requires std::is_arithmetic_v<E>
+	auto shortest_paths(graph<N, E, A> const& g, N const& src, path_workspace<E>& workspace)
+	   -> std::vector<std::pair<N, E>> {
+		using access = detail::graph_access;
+		auto const src_id = access::find_id(g, src);
+		if (!src_id) {
+			throw std::runtime_error("Cannot call gdwg::shortest_paths if src doesn't exist in the "
+			                         "graph");
+		}
+
+		workspace.run(g, *src_id, std::nullopt);
+		auto ret = std::vector<std::pair<N, E>>();
+		ret.reserve(workspace.reached().size());
+		for (auto id : workspace.reached()) {
+			ret.emplace_back(access::value(g, id), workspace.distance(id));
+		}
+		std::sort(ret.begin(), ret.end(), [](auto const& lhs, auto const& rhs) {
+			return lhs.first < rhs.first;
+		});
+		return ret;
+	}
+
+	template<typename N, typename E, typename A>
+	requires std::is_arithmetic_v<E>
+	auto shortest_paths(graph<N, E, A> const& g, N const& src) -> std::vector<std::pair<N, E>> {
+		auto workspace = path_workspace<E>();
+		return shortest_paths(g, src, workspace);
+	}
+
+	// The shortest path from `src` to `dst`, or nothing if `dst` can't be reached. The search
+	// stops as soon as `dst` is settled. Edge weights must not be negative.
+	template<typename N, typename E, typename A>
+	requires std::is_arithmetic_v<E>
+	auto shortest_path(graph<N, E, A> const& g,
+	                   N const& src,
+	                   N const& dst,
+	                   path_workspace<E>& workspace) -> std::optional<path<N, E>> {
+		using access = detail::graph_access;
+		auto const src_id = access::find_id(g, src);
+		auto const dst_id = access::find_id(g, dst);
+		if (!src_id || !dst_id) {
+			throw std::runtime_error("Cannot call gdwg::shortest_path if src or dst node don't exist "
+			                         "in the graph");
+		}
+
+		workspace.run(g, *src_id, dst_id);
+		if (!workspace.is_reached(*dst_id)) {
+			return std::nullopt;
+		}
+
+		auto ret = path<N, E>{workspace.distance(*dst_id), {}};
+		for (auto id = *dst_id; id != *src_id; id = workspace.parent(id)) {
+			ret.nodes.push_back(access::value(g, id));
+		}
+		ret.nodes.push_back(src);
+		std::reverse(ret.nodes.begin(), ret.nodes.end());
+		return ret;
+	}
+
+	template<typename N, typename E, typename A>
+	requires std::is_arithmetic_v<E>
+	auto shortest_path(graph<N, E, A> const& g, N const& src, N const& dst)
+	   -> std::optional<path<N, E>> {
+		auto workspace = path_workspace<E>();
+		return shortest_path(g, src, dst, workspace);
+	}
+
+	struct bfs_options {
+		// Nodes more than this many hops from the source are left out.
+		std::size_t max_hops = std::numeric_limits<std::size_t>::max();
+		// Worker threads to search with. Zero means one per hardware thread, scaled down for small
+		// graphs where starting threads would cost more than the search.
+		unsigned threads = 0;
+	};
+
+	namespace detail {
+		// Level-synchronous breadth-first search over node ids, run by a fixed set of workers that
+		// meet at a barrier after every level.
+		//
+		// Each level is expanded either top-down (the frontier's out-edges claim unvisited nodes) or
+		// bottom-up (every unvisited node scans its in-edges for a parent in the frontier). Which
+		// one is used follows Beamer et al., "Direction-Optimizing Breadth-First Search": switch to
+		// bottom-up once the frontier has more than 1/alpha of the unexplored edges, and back once
+		// it holds fewer than 1/beta of the nodes. Visited nodes and the bottom-up frontier are
+		// bitmaps, and work is handed out in chunks from an atomic cursor so that one high-degree
+		// node doesn't stall the level.
+		template<typename N, typename E, typename A>
+		class parallel_bfs {
+		public:
+			using node_id = typename graph<N, E, A>::node_id;
+			static constexpr auto unreached = std::numeric_limits<std::uint32_t>::max();
+
+			parallel_bfs(graph<N, E, A> const& g, unsigned threads)
+			: g_{g}
+			, n_{graph_access::id_bound(g)}
+			, words_{(n_ + 63) / 64}
+			, threads_{threads}
+			, can_go_bottom_up_{graph_access::has_in_edges(g)}
+			, visited_(words_)
+			, frontier_bits_(words_)
+			, next_bits_(words_)
+			, frontier_(n_)
+			, depth_(n_, unreached)
+			, locals_(threads)
+			, tallies_(threads)
+			, offsets_(threads) {}
+
+			// The hop count from `src` to every node id, or `unreached`.
+			auto run(node_id src, std::size_t max_hops) -> std::vector<std::uint32_t> {
+				depth_[src] = 0;
+				visited_[src / 64].store(bit(src), std::memory_order_relaxed);
+				frontier_[0] = src;
+				frontier_size_ = 1;
+				auto const src_edges = graph_access::out_degree(g_, src);
+				unexplored_ = graph_access::edge_count(g_) - src_edges;
+				max_hops_ = max_hops;
+				if (max_hops == 0) {
+					return std::move(depth_);
+				}
+
+				auto level_done = std::barrier(static_cast<std::ptrdiff_t>(threads_),
+				                               [this]() noexcept { end_level(); });
+				auto ready = std::barrier(static_cast<std::ptrdiff_t>(threads_), [this]() noexcept {
+					cursor_.store(0, std::memory_order_relaxed);
+				});
+				auto worker = [&](unsigned t) {
+					while (true) {
+						bottom_up_ ? step_bottom_up(t) : step_top_down(t);
+						level_done.arrive_and_wait();
+						if (done_) {
+							return;
+						}
+						prepare(t);
+						ready.arrive_and_wait();
+					}
+				};
+
+				// Work is handed out in chunks, so a worker that can't be started only needs to
+				// drop out of the barriers for the others to pick up its share.
+				run_workers(threads_, worker, [&](unsigned) {
+					level_done.arrive_and_drop();
+					ready.arrive_and_drop();
+				});
+				return std::move(depth_);
+			}
+
+		private:
+			static constexpr auto alpha = std::size_t{14};
+			static constexpr auto beta = std::size_t{24};
+			static constexpr auto node_chunk = std::size_t{64};
+			static constexpr auto word_chunk = std::size_t{16};
+
+			using bitmap = std::vector<std::atomic<std::uint64_t>>;
+
+			graph<N, E, A> const& g_;
+			std::size_t n_;
+			std::size_t words_;
+			unsigned threads_;
+			// Bottom-up steps read in-edges, so graphs without an in-edge index stay top-down.
+			bool can_go_bottom_up_;
+
+			bitmap visited_;
+			// Only used while bottom-up; all zero otherwise.
+			bitmap frontier_bits_;
+			bitmap next_bits_;
+			// The frontier as a list, while top-down.
+			std::vector<node_id> frontier_;
+			std::size_t frontier_size_ = 0;
+			std::vector<std::uint32_t> depth_;
+
+			// Per worker: the nodes it added to the next frontier, the out-degree they add up to, and
+			// where they go in `frontier_`.
+			std::vector<std::vector<node_id>> locals_;
+			std::vector<std::size_t> tallies_;
+			std::vector<std::size_t> offsets_;
+
+			std::atomic<std::size_t> cursor_ = 0;
+			std::uint32_t level_ = 0;
+			std::size_t max_hops_ = 0;
+			std::size_t unexplored_ = 0;
+			bool bottom_up_ = false;
+			bool was_bottom_up_ = false;
+			bool done_ = false;
+
+			static auto bit(node_id id) -> std::uint64_t {
+				return std::uint64_t{1} << (id % 64);
+			}
+
+			auto claim(node_id id) -> bool {
+				auto& word = visited_[id / 64];
+				if ((word.load(std::memory_order_relaxed) & bit(id)) != 0) {
+					return false;
+				}
+				return (word.fetch_or(bit(id), std::memory_order_relaxed) & bit(id)) == 0;
+			}
+
+			auto step_top_down(unsigned t) -> void {
+				auto& local = locals_[t];
+				auto edges = std::size_t{0};
+				while (true) {
+					auto const first = cursor_.fetch_add(node_chunk, std::memory_order_relaxed);
+					if (first >= frontier_size_) {
+						break;
+					}
+					auto const last = std::min(first + node_chunk, frontier_size_);
+					for (auto i = first; i < last; ++i) {
+						for (auto const& edge : graph_access::out_edges(g_, frontier_[i])) {
+							if (claim(edge.to)) {
+								depth_[edge.to] = level_ + 1;
+								local.push_back(edge.to);
+								edges += graph_access::out_degree(g_, edge.to);
+							}
+						}
+					}
+				}
+				tallies_[t] = edges;
+			}
+
+			// Each word of the bitmaps is owned by whichever worker took its chunk, so nothing here
+			// needs a read-modify-write.
+			auto step_bottom_up(unsigned t) -> void {
+				auto& local = locals_[t];
+				auto edges = std::size_t{0};
+				while (true) {
+					auto const first = cursor_.fetch_add(word_chunk, std::memory_order_relaxed);
+					if (first >= words_) {
+						break;
+					}
+					auto const last = std::min(first + word_chunk, words_);
+					for (auto w = first; w < last; ++w) {
+						auto const seen = visited_[w].load(std::memory_order_relaxed);
+						auto todo = ~seen;
+						if (w == words_ - 1 && n_ % 64 != 0) {
+							todo &= (std::uint64_t{1} << (n_ % 64)) - 1;
+						}
+						auto found = std::uint64_t{0};
+						while (todo != 0) {
+							auto const offset = static_cast<std::size_t>(std::countr_zero(todo));
+							auto const id = static_cast<node_id>(w * 64 + offset);
+							todo &= todo - 1;
+							for (auto const from : graph_access::in_sources(g_, id)) {
+								if ((frontier_bits_[from / 64].load(std::memory_order_relaxed) & bit(from))
+								    != 0) {
+									found |= bit(id);
+									depth_[id] = level_ + 1;
+									local.push_back(id);
+									edges += graph_access::out_degree(g_, id);
+									break;
+								}
+							}
+						}
+						next_bits_[w].store(found, std::memory_order_relaxed);
+						if (found != 0) {
+							visited_[w].store(seen | found, std::memory_order_relaxed);
+						}
+					}
+				}
+				tallies_[t] = edges;
+			}
+
+			// Runs on one worker while the others wait: totals the level and picks the next
+			// direction.
+			auto end_level() noexcept -> void {
+				auto count = std::size_t{0};
+				auto edges = std::size_t{0};
+				for (auto t = std::size_t{0}; t < threads_; ++t) {
+					offsets_[t] = count;
+					count += locals_[t].size();
+					edges += tallies_[t];
+				}
+
+				++level_;
+				unexplored_ -= std::min(unexplored_, edges);
+				done_ = count == 0 || level_ >= max_hops_;
+				was_bottom_up_ = bottom_up_;
+				if (!bottom_up_) {
+					bottom_up_ = can_go_bottom_up_ && count > frontier_size_
+					             && edges > unexplored_ / alpha;
+				}
+				else {
+					bottom_up_ = count >= n_ / beta;
+				}
+				if (bottom_up_ && was_bottom_up_) {
+					frontier_bits_.swap(next_bits_);
+				}
+				frontier_size_ = count;
+				cursor_.store(0, std::memory_order_relaxed);
+			}
+
+			// Turns each worker's share of the next frontier into whichever form the next level
+			// reads.
+			auto prepare(unsigned t) -> void {
+				auto& local = locals_[t];
+				if (!bottom_up_) {
+					std::copy(local.begin(),
+					          local.end(),
+					          frontier_.begin() + static_cast<std::ptrdiff_t>(offsets_[t]));
+					if (was_bottom_up_) {
+						while (true) {
+							auto const first = cursor_.fetch_add(word_chunk, std::memory_order_relaxed);
+							if (first >= words_) {
+								break;
+							}
+							for (auto w = first; w < std::min(first + word_chunk, words_); ++w) {
+								frontier_bits_[w].store(0, std::memory_order_relaxed);
+							}
+						}
+					}
+				}
+				else if (!was_bottom_up_) {
+					for (auto id : local) {
+						frontier_bits_[id / 64].fetch_or(bit(id), std::memory_order_relaxed);
+					}
+				}
+				local.clear();
+			}
+		};
+
+		template<typename N, typename E, typename A>
+		auto hop_levels(graph<N, E, A> const& g,
+		                typename graph<N, E, A>::node_id src,
+		                bfs_options const& options) -> std::vector<std::uint32_t> {
+			constexpr auto nodes_per_thread = std::size_t{4096};
+			auto const threads = options.threads == 0
+			                        ? default_threads(graph_access::id_bound(g), nodes_per_thread)
+			                        : options.threads;
+			return parallel_bfs<N, E, A>(g, threads).run(src, options.max_hops);
+		}
+	} // namespace detail
+
+	// The number of hops from `src` to every node it can reach within `options.max_hops`
+	// (including `src` itself, at zero hops), sorted by node. Runs on `options.threads` threads.
+	template<typename N, typename E, typename A>
+	auto hop_distances(graph<N, E, A> const& g, N const& src, bfs_options const& options = {})
+	   -> std::vector<std::pair<N, std::size_t>> {
+		auto const src_id = detail::graph_access::find_id(g, src);
+		if (!src_id) {
+			throw std::runtime_error("Cannot call gdwg::hop_distances if src doesn't exist in the "
+			                         "graph");
+		}
+
+		auto const depth = detail::hop_levels(g, *src_id, options);
+		auto ret = std::vector<std::pair<N, std::size_t>>();
+		for (auto const& [value, id] : detail::graph_access::index(g)) {
+			if (depth[id] != detail::parallel_bfs<N, E, A>::unreached) {
+				ret.emplace_back(value, depth[id]);
+			}
+		}
+		return ret;
+	}
+
+	// Every node `src` can reach within `options.max_hops`, including `src`, sorted.
+	template<typename N, typename E, typename A>
+	auto reachable(graph<N, E, A> const& g, N const& src, bfs_options const& options = {})
+	   -> std::vector<N> {
+		auto const src_id = detail::graph_access::find_id(g, src);
+		if (!src_id) {
+			throw std::runtime_error("Cannot call gdwg::reachable if src doesn't exist in the graph");
+		}
+
+		auto const depth = detail::hop_levels(g, *src_id, options);
+		auto ret = std::vector<N>();
+		for (auto const& [value, id] : detail::graph_access::index(g)) {
+			if (depth[id] != detail::parallel_bfs<N, E, A>::unreached) {
+				ret.push_back(value);
+			}
+		}
+		return ret;
+	}
+
+	struct iteration_options {
+		// Stop once an iteration changes the values by less than this in total (summing the
+		// absolute change of every node).
+		double tolerance = 1e-10;
+		std::size_t max_iterations = 100;
+		// Worker threads to iterate with. Zero means one per hardware thread, scaled down for small
+		// graphs.
+		unsigned threads = 0;
+	};
+
+	// The per-node computation `gather_apply::run` iterates. Each iteration, `start` is called once
+	// with the current values, then every node's next value is `apply(node, sum)`, where `sum` adds
+	// up `gather(src, values[src], weight)` over the node's in-edges. `gather` and `apply` are
+	// called from many threads at once, and none of the three may throw.
+	template<typename P>
+	concept gather_apply_program =
+	   requires(P& program, P const& cprogram, std::span<double const> values, std::size_t node) {
+		   program.start(values);
+		   { cprogram.gather(node, 0.0, 0.0) } -> std::convertible_to<double>;
+		   { cprogram.apply(node, 0.0) } -> std::convertible_to<double>;
+	   };
+
+	// A vertex-centric iteration engine over a flat copy of a graph's in-edges.
+	//
+	// Nodes are numbered by their position in value order, as in `csr_graph`. The edges into node
+	// `i` are `sources_[offsets_[i]]` to `sources_[offsets_[i + 1] - 1]`, sorted by source, with
+	// their weights as doubles in `weights_`: the weight itself when E is arithmetic, and 1
+	// otherwise. Each iteration pulls values along in-edges, so every node is written by exactly
+	// one worker and nothing is locked or atomic except the chunk counter.
+	class gather_apply {
+	public:
+		template<typename N, typename E, typename A>
+		explicit gather_apply(graph<N, E, A> const& g) {
+			using access = detail::graph_access;
+			auto position = std::vector<std::uint32_t>(access::id_bound(g));
+			auto n = std::uint32_t{0};
+			for (auto const& [value, id] : access::index(g)) {
+				position[id] = n++;
+			}
+
+			offsets_.assign(n + std::size_t{1}, 0);
+			for (auto const& [value, id] : access::index(g)) {
+				for (auto const& edge : access::out_edges(g, id)) {
+					++offsets_[position[edge.to] + 1];
+				}
+			}
+			std::partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+
+			sources_.resize(offsets_.back());
+			weights_.resize(offsets_.back());
+			out_weights_.assign(n, 0.0);
+			auto fill = std::vector<std::size_t>(offsets_.begin(), offsets_.end() - 1);
+			for (auto const& [value, id] : access::index(g)) {
+				auto const src = position[id];
+				for (auto const& edge : access::out_edges(g, id)) {
+					auto const weight = weight_of(edge.weight);
+					auto const slot = fill[position[edge.to]]++;
+					sources_[slot] = src;
+					weights_[slot] = weight;
+					out_weights_[src] += weight;
+				}
+			}
+		}
+
+		// The number of nodes.
+		[[nodiscard]] auto size() const -> std::size_t {
+			return out_weights_.size();
+		}
+
+		// The total weight of the edges leaving node `i`.
+		[[nodiscard]] auto out_weight(std::size_t i) const -> double {
+			return out_weights_[i];
+		}
+
+		// Runs `program` over `values`, which holds one value per node, until it converges or
+		// reaches `options.max_iterations`, and returns how many iterations it ran.
+		template<gather_apply_program P>
+		auto run(std::vector<double>& values, P& program, iteration_options const& options = {})
+		   const -> std::size_t {
+			if (values.size() != size()) {
+				throw std::runtime_error("Cannot call gdwg::gather_apply::run without exactly one "
+				                         "value per node");
+			}
+			if (size() == 0 || options.max_iterations == 0) {
+				return 0;
+			}
+
+			constexpr auto edges_per_thread = std::size_t{65536};
+			auto const threads = options.threads == 0
+			                        ? detail::default_threads(sources_.size(), edges_per_thread)
+			                        : options.threads;
+
+			auto next = std::vector<double>(values.size());
+			auto changes = std::vector<double>(threads);
+			auto cursor = std::atomic<std::size_t>(0);
+			auto iterations = std::size_t{0};
+			auto done = false;
+			program.start(std::span<double const>(values));
+
+			auto step = [&](unsigned t) {
+				auto const& cprogram = std::as_const(program);
+				auto change = 0.0;
+				while (true) {
+					auto const first = cursor.fetch_add(node_chunk, std::memory_order_relaxed);
+					if (first >= size()) {
+						break;
+					}
+					auto const last = std::min(first + node_chunk, size());
+					for (auto i = first; i < last; ++i) {
+						auto sum = 0.0;
+						for (auto e = offsets_[i]; e < offsets_[i + 1]; ++e) {
+							auto const src = sources_[e];
+							sum += cprogram.gather(src, values[src], weights_[e]);
+						}
+						next[i] = cprogram.apply(i, sum);
+						change += std::abs(next[i] - values[i]);
+					}
+				}
+				changes[t] = change;
+			};
+			auto end_iteration = [&]() noexcept {
+				++iterations;
+				values.swap(next);
+				auto const change = std::accumulate(changes.begin(), changes.end(), 0.0);
+				std::fill(changes.begin(), changes.end(), 0.0);
+				cursor.store(0, std::memory_order_relaxed);
+				done = change < options.tolerance || iterations == options.max_iterations;
+				if (!done) {
+					program.start(std::span<double const>(values));
+				}
+			};
+
+			auto iteration_done = std::barrier(static_cast<std::ptrdiff_t>(threads), end_iteration);
+			auto worker = [&](unsigned t) {
+				while (true) {
+					step(t);
+					iteration_done.arrive_and_wait();
+					if (done) {
+						return;
+					}
+				}
+			};
+			// A worker that can't be started leaves the barrier; its chunks go to the others.
+			detail::run_workers(threads, worker, [&](unsigned) { iteration_done.arrive_and_drop(); });
+			return iterations;
+		}
+
+	private:
+		static constexpr auto node_chunk = std::size_t{256};
+
+		std::vector<std::size_t> offsets_;
+		std::vector<std::uint32_t> sources_;
+		std::vector<double> weights_;
+		std::vector<double> out_weights_;
+
+		template<typename E>
+		static auto weight_of(E const& weight) -> double {
+			if constexpr (std::is_arithmetic_v<E>) {
+				return static_cast<double>(weight);
+			}
+			else {
+				return 1.0;
+			}
+		}
+	};
+
+	struct page_rank_options {
+		// The chance of following an edge rather than jumping to a random node.
+		double damping = 0.85;
+		double tolerance = 1e-10;
+		std::size_t max_iterations = 100;
+		unsigned threads = 0;
+	};
+
+	namespace detail {
+		// PageRank as a gather-apply program. A node passes its rank on along its out-edges in
+		// proportion to their weights, and the rank of nodes with no out-weight is spread evenly
+		// over every node. `start` does the per-node division once per iteration, in plain loops
+		// over double arrays, so gathering an edge is a single multiply.
+		class page_rank_program {
+		public:
+			page_rank_program(gather_apply const& engine, double damping)
+			: damping_{damping}
+			, inverse_out_(engine.size())
+			, dangling_(engine.size())
+			, scaled_(engine.size()) {
+				for (auto i = std::size_t{0}; i < engine.size(); ++i) {
+					auto const out = engine.out_weight(i);
+					inverse_out_[i] = out > 0 ? 1 / out : 0;
+					dangling_[i] = out > 0 ? 0 : 1;
+				}
+			}
+
+			auto start(std::span<double const> ranks) -> void {
+				auto dangling = 0.0;
+				for (auto i = std::size_t{0}; i < ranks.size(); ++i) {
+					scaled_[i] = ranks[i] * inverse_out_[i];
+					dangling += ranks[i] * dangling_[i];
+				}
+				auto const n = static_cast<double>(ranks.size());
+				base_ = (1 - damping_ + damping_ * dangling) / n;
+			}
+
+			auto gather(std::size_t src, double, double weight) const -> double {
+				return scaled_[src] * weight;
+			}
+
+			auto apply(std::size_t, double sum) const -> double {
+				return base_ + damping_ * sum;
+			}
+
+		private:
+			double damping_;
+			double base_ = 0;
+			std::vector<double> inverse_out_;
+			std::vector<double> dangling_;
+			std::vector<double> scaled_;
+		};
+	} // namespace detail
+
+	// The PageRank of every node, sorted by node. The ranks add up to 1. Edges are followed in
+	// proportion to their weights when E is arithmetic (weights must not be negative), and
+	// equally otherwise. Runs on `options.threads` threads.
+	template<typename N, typename E, typename A>
+	auto page_rank(graph<N, E, A> const& g, page_rank_options const& options = {})
+	   -> std::vector<std::pair<N, double>> {
+		using access = detail::graph_access;
+		if constexpr (std::is_arithmetic_v<E>) {
+			for (auto const& [value, id] : access::index(g)) {
+				for (auto const& edge : access::out_edges(g, id)) {
+					if (edge.weight < E{}) {
+						throw std::runtime_error("Cannot call gdwg::page_rank on a graph with "
+						                         "negative edge weights");
+					}
+				}
+			}
+		}
+
+		auto const engine = gather_apply(g);
+		if (engine.size() == 0) {
+			return {};
+		}
+		auto ranks = std::vector<double>(engine.size(), 1 / static_cast<double>(engine.size()));
+		auto program = detail::page_rank_program(engine, options.damping);
+		engine.run(ranks,
+		           program,
+		           {.tolerance = options.tolerance,
+		            .max_iterations = options.max_iterations,
+		            .threads = options.threads});
+
+		auto ret = std::vector<std::pair<N, double>>();
+		ret.reserve(ranks.size());
+		auto i = std::size_t{0};
+		for (auto const& [value, id] : access::index(g)) {
+			ret.emplace_back(value, ranks[i++]);
+		}
+		return ret;
+	}
+
+	// Scratch space for `strongly_connected_components`, `topological_order` and `has_cycle`. As
+	// with `path_workspace`, its arrays are indexed by node id and only ever grow, so reusing one
+	// workspace allocates nothing once it has seen the largest graph it is used with.
+	class traversal_workspace {
+	public:
+		using node_id = std::uint32_t;
+
+		// Tarjan's algorithm, with an explicit stack in place of recursion so that long chains
+		// can't overflow the call stack. Returns the number of strongly connected components.
+		// Afterwards `component(id)` numbers them in the order they were completed, which means
+		// edges between two components always go to the lower-numbered one.
+		template<typename N, typename E, typename A>
+		auto find_components(graph<N, E, A> const& g) -> std::size_t {
+			using access = detail::graph_access;
+			auto const bound = access::id_bound(g);
+			index_.assign(bound, none);
+			low_.assign(bound, none);
+			component_.assign(bound, none);
+			stack_.clear();
+			visits_.clear();
+
+			auto next_index = node_id{0};
+			auto components = node_id{0};
+			for (auto const& [value, root] : access::index(g)) {
+				if (index_[root] != none) {
+					continue;
+				}
+				visits_.push_back({root, none, false});
+				while (!visits_.empty()) {
+					auto const [id, parent, leaving] = visits_.back();
+					visits_.pop_back();
+					if (leaving) {
+						if (low_[id] == index_[id]) {
+							auto member = none;
+							do {
+								member = stack_.back();
+								stack_.pop_back();
+								component_[member] = components;
+							} while (member != id);
+							++components;
+						}
+						else {
+							low_[parent] = std::min(low_[parent], low_[id]);
+						}
+						continue;
+					}
+
+					if (index_[id] != none) {
+						// Seen before: only an edge back into the current search matters.
+						if (parent != none && component_[id] == none) {
+							low_[parent] = std::min(low_[parent], index_[id]);
+						}
+						continue;
+					}
+					index_[id] = next_index;
+					low_[id] = next_index;
+					++next_index;
+					stack_.push_back(id);
+					// Popped once every edge pushed after it has been followed.
+					visits_.push_back({id, parent, true});
+					for (auto const& edge : access::out_edges(g, id)) {
+						visits_.push_back({edge.to, id, false});
+					}
+				}
+			}
+			return components;
+		}
+
+		// Kahn's algorithm. Returns whether the graph has no cycles; if so, `order()` lists every
+		// node so that all edges go forwards. Otherwise it only lists the nodes that don't depend
+		// on a cycle.
+		template<typename N, typename E, typename A>
+		auto sort_topologically(graph<N, E, A> const& g) -> bool {
+			using access = detail::graph_access;
+			in_degree_.assign(access::id_bound(g), 0);
+			order_.clear();
+			for (auto const& [value, id] : access::index(g)) {
+				for (auto const& edge : access::out_edges(g, id)) {
+					++in_degree_[edge.to];
+				}
+			}
+			for (auto const& [value, id] : access::index(g)) {
+				if (in_degree_[id] == 0) {
+					order_.push_back(id);
+				}
+			}
+			// `order_` doubles as the queue of nodes whose predecessors are all placed.
+			for (auto i = std::size_t{0}; i < order_.size(); ++i) {
+				for (auto const& edge : access::out_edges(g, order_[i])) {
+					if (--in_degree_[edge.to] == 0) {
+						order_.push_back(edge.to);
+					}
+				}
+			}
+			return order_.size() == access::index(g).size();
+		}
+
+		[[nodiscard]] auto component(node_id id) const -> std::size_t {
+			return component_[id];
+		}
+
+		[[nodiscard]] auto order() const -> std::vector<node_id> const& {
+			return order_;
+		}
+
+	private:
+		static constexpr auto none = std::numeric_limits<node_id>::max();
+
+		// A step of the search: entering `node` along an edge from `parent`, or leaving it.
+		struct visit {
+			node_id node;
+			node_id parent;
+			bool leaving;
+		};
+
+		// The order nodes were first reached in, or `none`.
+		std::vector<node_id> index_;
+		// The lowest `index_` known to be reachable from the node while it's on `stack_`.
+		std::vector<node_id> low_;
+		// `none` until the node's component is complete.
+		std::vector<node_id> component_;
+		std::vector<node_id> stack_;
+		std::vector<visit> visits_;
+		std::vector<std::size_t> in_degree_;
+		std::vector<node_id> order_;
+	};
+
+	// The strongly connected components of `g`, each sorted by node. Components are listed in
+	// topological order: every edge between two of them goes from an earlier one to a later one.
+	// Runs in O(V + E).
+	template<typename N, typename E, typename A>
+	auto strongly_connected_components(graph<N, E, A> const& g, traversal_workspace& workspace)
+	   -> std::vector<std::vector<N>> {
+		using access = detail::graph_access;
+		auto const count = workspace.find_components(g);
+		auto ret = std::vector<std::vector<N>>(count);
+		for (auto const& [value, id] : access::index(g)) {
+			ret[count - 1 - workspace.component(id)].push_back(value);
+		}
+		return ret;
+	}
+
+	template<typename N, typename E, typename A>
+	auto strongly_connected_components(graph<N, E, A> const& g) -> std::vector<std::vector<N>> {
+		auto workspace = traversal_workspace();
+		return strongly_connected_components(g, workspace);
+	}
+
+	// Every node, ordered so that all edges go forwards, or nothing if `g` has a cycle (including
+	// an edge from a node to itself). Runs in O(V + E).
+	template<typename N, typename E, typename A>
+	auto topological_order(graph<N, E, A> const& g, traversal_workspace& workspace)
+	   -> std::optional<std::vector<N>> {
+		if (!workspace.sort_topologically(g)) {
+			return std::nullopt;
+		}
+		auto ret = std::vector<N>();
+		ret.reserve(workspace.order().size());
+		for (auto id : workspace.order()) {
+			ret.push_back(detail::graph_access::value(g, id));
+		}
+		return ret;
+	}
+
+	template<typename N, typename E, typename A>
+	auto topological_order(graph<N, E, A> const& g) -> std::optional<std::vector<N>> {
+		auto workspace = traversal_workspace();
+		return topological_order(g, workspace);
+	}
+
+	template<typename N, typename E, typename A>
+	auto has_cycle(graph<N, E, A> const& g, traversal_workspace& workspace) -> bool {
+		return !workspace.sort_topologically(g);
+	}
+
+	template<typename N, typename E, typename A>
+	auto has_cycle(graph<N, E, A> const& g) -> bool {
+		auto workspace = traversal_workspace();
+		return has_cycle(g, workspace);
+	}
+} // namespace gdwg
+
+#endif // GDWG_ALGORITHM_HPP
@@ -0,0 +1,480 @@
+#ifndef GDWG_BINARY_IO_HPP
+#define GDWG_BINARY_IO_HPP
+
+#include "gdwg/graph.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A binary file format for graphs, and a reader that serves queries straight out of a memory
+// mapping of one.
+//
+// A file is a header followed by four sections, each starting on a 16-byte boundary:
+//
+//     offsets  node_count + 1 uint64s: the edges leaving node i are offsets[i] to offsets[i + 1]
+//     targets  edge_count uint32s: the position in `nodes` of each edge's destination
+//     nodes    the node values, sorted
+//     weights  edge_count weights, in the same order as `targets`
+//
+// This is the layout of `csr_graph`, so each node's edges are sorted by (destination, weight).
+// Values are written in the machine's own byte order, which the header records.
+namespace gdwg {
+	// How a type is stored in a graph file. Every type needs a `tag` that identifies it, so a file
+	// can't be read back as the wrong type. Trivially copyable types are stored as their bytes and
+	// need nothing else; other types also provide
+	//
+	//     static auto encode(std::string& out, T const& value) -> void;
+	//     static auto decode(std::string_view& in) -> T;
+	//
+	// where `decode` consumes what `encode` appended and throws if `in` is too short. Only graphs
+	// whose node and weight types are both stored as bytes can be used with `mapped_graph`.
+	template<typename T>
+	struct binary_traits;
+
+	template<typename T>
+	requires std::is_arithmetic_v<T>
+	struct binary_traits<T> {
+		static constexpr auto tag =
+		   std::uint64_t{std::is_floating_point_v<T> ? 'f' : std::is_signed_v<T> ? 'i' : 'u'} << 8
+		   | sizeof(T);
+	};
+
+	template<>
+	struct binary_traits<std::string> {
+		static constexpr auto tag = std::uint64_t{'s'} << 8;
+
+		static auto encode(std::string& out, std::string const& value) -> void {
+			auto const size = static_cast<std::uint64_t>(value.size());
+			out.append(reinterpret_cast<char const*>(&size), sizeof(size));
+			out.append(value);
+		}
+
+		static auto decode(std::string_view& in) -> std::string {
+			auto size = std::uint64_t{0};
+			if (in.size() < sizeof(size)) {
+				throw std::runtime_error("Cannot decode a std::string from a truncated graph file");
+			}
+			std::memcpy(&size, in.data(), sizeof(size));
+			in.remove_prefix(sizeof(size));
+			if (in.size() < size) {
+				throw std::runtime_error("Cannot decode a std::string from a truncated graph file");
+			}
+			auto ret = std::string(in.substr(0, size));
+			in.remove_prefix(size);
+			return ret;
+		}
+	};
+
+	namespace detail {
+		template<typename T>
+		concept binary_tagged = requires {
+			{ binary_traits<T>::tag } -> std::convertible_to<std::uint64_t>;
+		};
+
+		template<typename T>
+		concept binary_encoded = binary_tagged<T>
+		                         && requires(std::string& out, T const& value, std::string_view& in) {
+			                            binary_traits<T>::encode(out, value);
+			                            { binary_traits<T>::decode(in) } -> std::same_as<T>;
+		                         };
+
+		template<typename T>
+		concept binary_fixed = binary_tagged<T> && !binary_encoded<T>
+		                       && std::is_trivially_copyable_v<T>;
+
+		template<typename T>
+		concept binary_storable = binary_fixed<T> || binary_encoded<T>;
+
+		struct file_header {
+			static constexpr auto expected_magic =
+			   std::array<char, 8>{'g', 'd', 'w', 'g', 'b', 'i', 'n', 0};
+			static constexpr auto current_version = std::uint32_t{1};
+			static constexpr auto native_order = std::uint32_t{0x01020304};
+
+			std::array<char, 8> magic = expected_magic;
+			std::uint32_t version = current_version;
+			std::uint32_t byte_order = native_order;
+			std::uint64_t node_tag = 0;
+			std::uint64_t weight_tag = 0;
+			// sizeof the node and weight types if they are stored as bytes, otherwise zero.
+			std::uint64_t node_size = 0;
+			std::uint64_t weight_size = 0;
+			std::uint64_t node_count = 0;
+			std::uint64_t edge_count = 0;
+			std::uint64_t offsets_at = 0;
+			std::uint64_t targets_at = 0;
+			std::uint64_t nodes_at = 0;
+			std::uint64_t weights_at = 0;
+			std::uint64_t file_size = 0;
+		};
+
+		static_assert(std::is_trivially_copyable_v<file_header>);
+
+		constexpr auto section_alignment = std::uint64_t{16};
+
+		constexpr auto align_section(std::uint64_t at) -> std::uint64_t {
+			return (at + section_alignment - 1) / section_alignment * section_alignment;
+		}
+
+		template<typename T>
+		constexpr auto stored_size() -> std::uint64_t {
+			if constexpr (binary_fixed<T>) {
+				return sizeof(T);
+			}
+			else {
+				return 0;
+			}
+		}
+
+		template<typename T>
+		auto encode_values(std::string& out, std::span<T const> values) -> void {
+			if constexpr (binary_fixed<T>) {
+				out.append(reinterpret_cast<char const*>(values.data()), values.size_bytes());
+			}
+			else {
+				for (auto const& value : values) {
+					binary_traits<T>::encode(out, value);
+				}
+			}
+		}
+
+		// Reads `count` values from the start of `in`, which holds at least that many if T is
+		// stored as bytes.
+		template<typename T>
+		auto decode_values(std::string_view in, std::uint64_t count) -> std::vector<T> {
+			auto ret = std::vector<T>();
+			if constexpr (binary_fixed<T>) {
+				ret.resize(count);
+				if (count > 0) {
+					std::memcpy(ret.data(), in.data(), count * sizeof(T));
+				}
+			}
+			else {
+				ret.reserve(count);
+				for (auto i = std::uint64_t{0}; i < count; ++i) {
+					ret.push_back(binary_traits<T>::decode(in));
+				}
+			}
+			return ret;
+		}
+
+		// Checks that `header` describes a graph of N and E that fits in `size` bytes, with every
+		// section in bounds. `what` names the caller in error messages.
+		template<typename N, typename E>
+		auto check_header(file_header const& header, std::uint64_t size, std::string const& what)
+		   -> void {
+			if (size < sizeof(file_header) || header.magic != file_header::expected_magic
+			    || header.version != file_header::current_version)
+			{
+				throw std::runtime_error("Cannot call " + what + " on data that isn't a graph file");
+			}
+			if (header.byte_order != file_header::native_order) {
+				throw std::runtime_error("Cannot call " + what
+				                         + " on a graph file written with a different byte order");
+			}
+			if (header.node_tag != binary_traits<N>::tag || header.weight_tag != binary_traits<E>::tag
+			    || header.node_size != stored_size<N>() || header.weight_size != stored_size<E>())
+			{
+				throw std::runtime_error("Cannot call " + what
+				                         + " on a graph file saved with different node or weight "
+				                           "types");
+			}
+
+			auto const in_bounds = [&](std::uint64_t at, std::uint64_t count, std::uint64_t each) {
+				return at % section_alignment == 0 && at <= size
+				       && (each == 0 || count <= (size - at) / each);
+			};
+			if (header.file_size != size || header.node_count >= std::uint64_t{1} << 32
+			    || !in_bounds(header.offsets_at, header.node_count + 1, sizeof(std::uint64_t))
+			    || !in_bounds(header.targets_at, header.edge_count, sizeof(std::uint32_t))
+			    || !in_bounds(header.nodes_at, header.node_count, header.node_size)
+			    || !in_bounds(header.weights_at, header.edge_count, header.weight_size))
+			{
+				throw std::runtime_error("Cannot call " + what + " on a truncated graph file");
+			}
+		}
+	} // namespace detail
+
+	// Writes `g` to `os` in the binary graph format. `os` should be opened in binary mode.
+	template<typename N, typename E, typename A>
+	requires detail::binary_storable<N> && detail::binary_storable<E>
+	auto save_graph(std::ostream& os, graph<N, E, A> const& g) -> void {
+		using access = detail::graph_access;
+		auto const& index = access::index(g);
+
+		// Positions in the sorted node list, by id.
+		auto position = std::vector<std::uint32_t>(access::id_bound(g));
+		auto nodes = std::vector<N>();
+		nodes.reserve(index.size());
+		for (auto const& [value, id] : index) {
+			position[id] = static_cast<std::uint32_t>(nodes.size());
+			nodes.push_back(value);
+		}
+
+		auto offsets = std::vector<std::uint64_t>{0};
+		offsets.reserve(index.size() + 1);
+		auto targets = std::vector<std::uint32_t>();
+		auto weights = std::vector<E>();
+		targets.reserve(access::edge_count(g));
+		weights.reserve(access::edge_count(g));
+		for (auto const& [value, id] : index) {
+			for (auto const& edge : access::out_edges(g, id)) {
+				targets.push_back(position[edge.to]);
+				weights.push_back(edge.weight);
+			}
+			offsets.push_back(targets.size());
+		}
+
+		auto node_bytes = std::string();
+		detail::encode_values(node_bytes, std::span<N const>(nodes));
+		auto weight_bytes = std::string();
+		detail::encode_values(weight_bytes, std::span<E const>(weights));
+
+		auto header = detail::file_header{};
+		header.node_tag = binary_traits<N>::tag;
+		header.weight_tag = binary_traits<E>::tag;
+		header.node_size = detail::stored_size<N>();
+		header.weight_size = detail::stored_size<E>();
+		header.node_count = nodes.size();
+		header.edge_count = targets.size();
+		header.offsets_at = detail::align_section(sizeof(header));
+		header.targets_at =
+		   detail::align_section(header.offsets_at + offsets.size() * sizeof(std::uint64_t));
+		header.nodes_at =
+		   detail::align_section(header.targets_at + targets.size() * sizeof(std::uint32_t));
+		header.weights_at = detail::align_section(header.nodes_at + node_bytes.size());
+		header.file_size = header.weights_at + weight_bytes.size();
+
+		auto written = std::uint64_t{0};
+		auto const write = [&os, &written](void const* data, std::uint64_t size) {
+			os.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+			written += size;
+		};
+		auto const pad_to = [&](std::uint64_t at) {
+			constexpr auto zeros = std::array<char, detail::section_alignment>{};
+			write(zeros.data(), at - written);
+		};
+		write(&header, sizeof(header));
+		pad_to(header.offsets_at);
+		write(offsets.data(), offsets.size() * sizeof(std::uint64_t));
+		pad_to(header.targets_at);
+		write(targets.data(), targets.size() * sizeof(std::uint32_t));
+		pad_to(header.nodes_at);
+		write(node_bytes.data(), node_bytes.size());
+		pad_to(header.weights_at);
+		write(weight_bytes.data(), weight_bytes.size());
+	}
+
+	// Reads a graph written by `save_graph` back from `is`, which should be opened in binary mode.
+	template<typename N, typename E, typename A = std::allocator<N>>
+	requires detail::binary_storable<N> && detail::binary_storable<E>
+	auto load_graph(std::istream& is, A const& alloc = A()) -> graph<N, E, A> {
+		auto const bytes = std::string(std::istreambuf_iterator<char>(is), {});
+		auto header = detail::file_header{};
+		if (bytes.size() >= sizeof(header)) {
+			std::memcpy(&header, bytes.data(), sizeof(header));
+		}
+		detail::check_header<N, E>(header, bytes.size(), "gdwg::load_graph");
+
+		auto const section = [&bytes](std::uint64_t at, std::uint64_t end) {
+			return std::string_view(bytes).substr(at, end - at);
+		};
+		auto const offsets = detail::decode_values<std::uint64_t>(
+		   section(header.offsets_at, header.targets_at), header.node_count + 1);
+		auto const targets = detail::decode_values<std::uint32_t>(
+		   section(header.targets_at, header.nodes_at), header.edge_count);
+		auto const nodes =
+		   detail::decode_values<N>(section(header.nodes_at, header.weights_at), header.node_count);
+		auto const weights = detail::decode_values<E>(section(header.weights_at, header.file_size),
+		                                              header.edge_count);
+
+		auto g = graph<N, E, A>(nodes.begin(), nodes.end(), alloc);
+		auto edges = std::vector<typename graph<N, E, A>::value_type>();
+		edges.reserve(header.edge_count);
+		for (auto from = std::size_t{0}; from < nodes.size(); ++from) {
+			if (offsets[from] > offsets[from + 1] || offsets[from + 1] > header.edge_count) {
+				throw std::runtime_error("Cannot call gdwg::load_graph on a corrupt graph file");
+			}
+			for (auto edge = offsets[from]; edge < offsets[from + 1]; ++edge) {
+				if (targets[edge] >= nodes.size()) {
+					throw std::runtime_error("Cannot call gdwg::load_graph on a corrupt graph file");
+				}
+				edges.push_back({nodes[from], nodes[targets[edge]], weights[edge]});
+			}
+		}
+		g.insert_edges(std::make_move_iterator(edges.begin()), std::make_move_iterator(edges.end()));
+		return g;
+	}
+
+	// A read-only graph served directly out of a memory-mapped graph file. Opening one maps the
+	// file and checks its header; nothing is copied or rebuilt, so start-up time doesn't depend on
+	// the size of the graph, and pages are only read in as queries touch them.
+	//
+	// Beyond the header the file is trusted, as a file written by `save_graph` would be.
+	template<typename N, typename E>
+	requires detail::binary_fixed<N> && detail::binary_fixed<E>
+	class mapped_graph {
+	public:
+		explicit mapped_graph(std::filesystem::path const& path) {
+			auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0) {
+				throw std::system_error(errno, std::generic_category(), "Cannot open " + path.string());
+			}
+			struct ::stat status {};
+			if (::fstat(fd, &status) != 0) {
+				auto const error = errno;
+				::close(fd);
+				throw std::system_error(error, std::generic_category(), "Cannot stat " + path.string());
+			}
+			size_ = static_cast<std::size_t>(status.st_size);
+			if (size_ > 0) {
+				data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			}
+			auto const error = errno;
+			::close(fd);
+			if (data_ == MAP_FAILED) {
+				data_ = nullptr;
+				throw std::system_error(error, std::generic_category(), "Cannot map " + path.string());
+			}
+
+			try {
+				auto header = detail::file_header{};
+				if (size_ >= sizeof(header)) {
+					std::memcpy(&header, data_, sizeof(header));
+				}
+				detail::check_header<N, E>(header, size_, "gdwg::mapped_graph<N, E>::mapped_graph");
+				auto const* base = static_cast<std::byte const*>(data_);
+				offsets_ = {reinterpret_cast<std::uint64_t const*>(base + header.offsets_at),
+				            header.node_count + 1};
+				targets_ = {reinterpret_cast<std::uint32_t const*>(base + header.targets_at),
+				            header.edge_count};
+				nodes_ = {reinterpret_cast<N const*>(base + header.nodes_at), header.node_count};
+				weights_ = {reinterpret_cast<E const*>(base + header.weights_at), header.edge_count};
+				if (offsets_.back() != header.edge_count) {
+					throw std::runtime_error("Cannot call gdwg::mapped_graph<N, E>::mapped_graph on a "
+					                         "corrupt graph file");
+				}
+			} catch (...) {
+				unmap();
+				throw;
+			}
+		}
+
+		mapped_graph(mapped_graph&& other) noexcept
+		: data_{std::exchange(other.data_, nullptr)}
+		, size_{std::exchange(other.size_, 0)}
+		, offsets_{other.offsets_}
+		, targets_{other.targets_}
+		, nodes_{other.nodes_}
+		, weights_{other.weights_} {}
+
+		auto operator=(mapped_graph&& other) noexcept -> mapped_graph& {
+			if (this != &other) {
+				unmap();
+				data_ = std::exchange(other.data_, nullptr);
+				size_ = std::exchange(other.size_, 0);
+				offsets_ = other.offsets_;
+				targets_ = other.targets_;
+				nodes_ = other.nodes_;
+				weights_ = other.weights_;
+			}
+			return *this;
+		}
+
+		~mapped_graph() {
+			unmap();
+		}
+
+		// Every node, sorted; a view into the mapping.
+		[[nodiscard]] auto nodes() const -> std::span<N const> {
+			return nodes_;
+		}
+
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return std::binary_search(nodes_.begin(), nodes_.end(), value);
+		}
+
+		[[nodiscard]] auto empty() const -> bool {
+			return nodes_.empty();
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			auto const [first, last, dst_at] = row(src, dst, "is_connected");
+			return std::binary_search(first, last, dst_at);
+		}
+
+		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
+			auto const [first, last, dst_at] = row(src, dst, "weights");
+			auto const [lower, upper] = std::equal_range(first, last, dst_at);
+			return std::vector<E>(weights_.begin() + (lower - targets_.begin()),
+			                      weights_.begin() + (upper - targets_.begin()));
+		}
+
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			auto const [first, last, src_at] = row(src, src, "connections");
+			std::vector<N> ret;
+			for (auto it = first; it != last; it++) {
+				if (it == first || *it != *(it - 1)) {
+					ret.push_back(nodes_[*it]);
+				}
+			}
+			return ret;
+		}
+
+	private:
+		using target_iterator = typename std::span<std::uint32_t const>::iterator;
+
+		void* data_ = nullptr;
+		std::size_t size_ = 0;
+		std::span<std::uint64_t const> offsets_;
+		std::span<std::uint32_t const> targets_;
+		std::span<N const> nodes_;
+		std::span<E const> weights_;
+
+		auto unmap() noexcept -> void {
+			if (data_ != nullptr) {
+				::munmap(data_, size_);
+				data_ = nullptr;
+			}
+		}
+
+		// The targets of `src`'s edges, and the position of `dst`.
+		[[nodiscard]] auto row(N const& src, N const& dst, char const* what) const
+		   -> std::tuple<target_iterator, target_iterator, std::uint32_t> {
+			auto const src_it = std::lower_bound(nodes_.begin(), nodes_.end(), src);
+			auto const dst_it = std::lower_bound(nodes_.begin(), nodes_.end(), dst);
+			if (src_it == nodes_.end() || *src_it != src || dst_it == nodes_.end() || *dst_it != dst) {
+				throw std::runtime_error(std::string("Cannot call gdwg::mapped_graph<N, E>::") + what
+				                         + " if src or dst node don't exist in the graph");
+			}
+			auto const from = static_cast<std::size_t>(src_it - nodes_.begin());
+			return {targets_.begin() + static_cast<std::ptrdiff_t>(offsets_[from]),
+			        targets_.begin() + static_cast<std::ptrdiff_t>(offsets_[from + 1]),
+			        static_cast<std::uint32_t>(dst_it - nodes_.begin())};
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_BINARY_IO_HPP
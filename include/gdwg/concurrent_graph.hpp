@@ -0,0 +1,120 @@
+#ifndef GDWG_CONCURRENT_GRAPH_HPP
+#define GDWG_CONCURRENT_GRAPH_HPP
+
+#include "gdwg/graph.hpp"
+
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+namespace gdwg {
+	// A graph shared between threads, published as a series of immutable snapshots.
+	//
+	// Readers call `snapshot()` and query the graph it returns through the (const) graph API. A
+	// snapshot is a `shared_ptr` to a graph that is never modified again, so it stays valid and
+	// unchanged for as long as the reader holds on to it, whatever writers do in the meantime.
+	// Taking one only holds a lock for as long as it takes to copy the pointer; readers never wait
+	// for a writer to finish its edits.
+	//
+	// Writers call `update` with a function that edits a graph. It runs on a private copy of the
+	// latest snapshot, which is then published by swapping the snapshot pointer under a mutex that
+	// is held for just that swap, so readers see either none or all of an update. Writers are
+	// serialised with each other. Every update copies the whole graph, O(V + E), so group writes
+	// that arrive together into one update rather than publishing them one at a time.
+	template<typename N, typename E, typename Allocator = std::allocator<N>>
+	class concurrent_graph {
+	public:
+		using graph_type = graph<N, E, Allocator>;
+		using snapshot_type = std::shared_ptr<graph_type const>;
+
+		concurrent_graph()
+		: concurrent_graph(graph_type()) {}
+
+		explicit concurrent_graph(graph_type g)
+		: current_{std::make_shared<graph_type const>(std::move(g))} {}
+
+		concurrent_graph(concurrent_graph const&) = delete;
+		auto operator=(concurrent_graph const&) -> concurrent_graph& = delete;
+
+		// The latest published graph.
+		[[nodiscard]] auto snapshot() const -> snapshot_type {
+			auto const lock = std::lock_guard(publish_);
+			return current_;
+		}
+
+		// Calls `f` with a copy of the latest graph, publishes the copy once `f` returns, and gives
+		// back whatever `f` returned. If `f` throws, nothing is published.
+		template<typename F>
+		requires std::invocable<F, graph_type&>
+		auto update(F&& f) -> std::invoke_result_t<F, graph_type&> {
+			auto const lock = std::lock_guard(writer_);
+			// Only writers replace `current_`, so it can be read here without `publish_`.
+			auto next = std::make_shared<graph_type>(*current_, current_->get_allocator());
+
+			if constexpr (std::is_void_v<std::invoke_result_t<F, graph_type&>>) {
+				std::invoke(std::forward<F>(f), *next);
+				publish(std::move(next));
+			}
+			else {
+				auto result = std::invoke(std::forward<F>(f), *next);
+				publish(std::move(next));
+				return result;
+			}
+		}
+
+		// Single edits, each published on its own. Each one is a full `update`, so it costs
+		// O(V + E) however small the edit is. Only use these for rare edits; batch anything else
+		// into one `update`.
+
+		// O(V + E): copies the whole graph to insert one node.
+		auto insert_node(N const& value) -> bool {
+			return update([&value](graph_type& g) { return g.insert_node(value); });
+		}
+
+		// O(V + E): copies the whole graph to insert one edge.
+		auto insert_edge(N const& src, N const& dst, E const& weight) -> bool {
+			return update([&](graph_type& g) { return g.insert_edge(src, dst, weight); });
+		}
+
+		// O(V + E): copies the whole graph to rename one node.
+		auto replace_node(N const& old_data, N const& new_data) -> bool {
+			return update([&](graph_type& g) { return g.replace_node(old_data, new_data); });
+		}
+
+		// O(V + E): copies the whole graph to merge one node.
+		auto merge_replace_node(N const& old_data, N const& new_data) -> void {
+			update([&](graph_type& g) { g.merge_replace_node(old_data, new_data); });
+		}
+
+		// O(V + E): copies the whole graph to erase one node.
+		auto erase_node(N const& value) -> bool {
+			return update([&value](graph_type& g) { return g.erase_node(value); });
+		}
+
+		// O(V + E): copies the whole graph to erase one edge.
+		auto erase_edge(N const& src, N const& dst, E const& weight) -> bool {
+			return update([&](graph_type& g) { return g.erase_edge(src, dst, weight); });
+		}
+
+	private:
+		snapshot_type current_;
+		// Guards `current_` itself, not the graph it points to.
+		mutable std::mutex publish_;
+		// Held for the whole of an update.
+		std::mutex writer_;
+
+		// The old snapshot is released outside the lock, so if this was the last reference the
+		// graph isn't destroyed while readers wait.
+		auto publish(snapshot_type next) -> void {
+			{
+				auto const lock = std::lock_guard(publish_);
+				current_.swap(next);
+			}
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_CONCURRENT_GRAPH_HPP
@@ -0,0 +1,238 @@
+#ifndef GDWG_CSR_GRAPH_HPP
+#define GDWG_CSR_GRAPH_HPP
+
+#include "gdwg/graph.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace gdwg {
+	// An immutable, compressed sparse row copy of a `graph`, for workloads that build a graph once
+	// and then only query it.
+	//
+	// Nodes are kept sorted in one contiguous array, so a node's position in it is its id. The
+	// edges leaving node `i` are `targets_[offsets_[i]]` to `targets_[offsets_[i + 1] - 1]`, with
+	// matching weights in `weights_`. Each row is sorted by (target, weight), which is the same
+	// order `graph` iterates in, so lookups are binary searches over flat arrays.
+	template<typename N, typename E>
+	class csr_graph {
+	public:
+		using node_id = std::uint32_t;
+		using value_type = typename graph<N, E>::value_type;
+		using reference = typename graph<N, E>::reference;
+
+		class iterator {
+		public:
+			using value_type = csr_graph::value_type;
+			using reference = csr_graph::reference;
+			using pointer = void;
+			using difference_type = std::ptrdiff_t;
+			using iterator_category = std::bidirectional_iterator_tag;
+
+			iterator() = default;
+
+			auto operator*() const -> reference {
+				return reference{graph_->nodes_[from_],
+				                 graph_->nodes_[graph_->targets_[edge_]],
+				                 graph_->weights_[edge_]};
+			}
+
+			auto operator++() -> iterator& {
+				++edge_;
+				while (from_ < graph_->nodes_.size() && graph_->offsets_[from_ + 1] <= edge_) {
+					++from_;
+				}
+				return *this;
+			}
+			auto operator++(int) -> iterator {
+				auto old = *this;
+				++*(this);
+				return old;
+			}
+
+			auto operator--() -> iterator& {
+				--edge_;
+				while (graph_->offsets_[from_] > edge_) {
+					--from_;
+				}
+				return *this;
+			}
+			auto operator--(int) -> iterator {
+				auto old = *this;
+				--*(this);
+				return old;
+			}
+
+			auto operator==(iterator const& other) const -> bool {
+				return edge_ == other.edge_;
+			}
+
+		private:
+			csr_graph const* graph_ = nullptr;
+			std::size_t from_ = 0;
+			std::size_t edge_ = 0;
+
+			iterator(csr_graph const* g, std::size_t from, std::size_t edge)
+			: graph_{g}
+			, from_{from}
+			, edge_{edge} {}
+
+			friend class csr_graph;
+		};
+
+		csr_graph() = default;
+
+		template<typename Allocator>
+		explicit csr_graph(graph<N, E, Allocator> const& g)
+		: nodes_{g.nodes()} {
+			offsets_.reserve(nodes_.size() + 1);
+
+			// `g` iterates its edges sorted by source, so rows can be closed off as the source moves
+			// forward through `nodes_`.
+			auto from = std::size_t{0};
+			for (auto const& [src, dst, weight] : g) {
+				while (nodes_[from] != src) {
+					offsets_.push_back(targets_.size());
+					++from;
+				}
+				targets_.push_back(*id_of(dst));
+				weights_.push_back(weight);
+			}
+			while (offsets_.size() < nodes_.size() + 1) {
+				offsets_.push_back(targets_.size());
+			}
+		}
+
+		[[nodiscard]] auto begin() const -> iterator {
+			return iterator(this, first_row_from(0), 0);
+		}
+
+		[[nodiscard]] auto end() const -> iterator {
+			return iterator(this, nodes_.size(), targets_.size());
+		}
+
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return id_of(value).has_value();
+		}
+
+		[[nodiscard]] auto empty() const -> bool {
+			return nodes_.empty();
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			auto const src_id = id_of(src);
+			auto const dst_id = id_of(dst);
+			if (!src_id || !dst_id) {
+				throw std::runtime_error("Cannot call gdwg::csr_graph<N, E>::is_connected if src or "
+				                         "dst node don't exist in the graph");
+			}
+			auto [first, last] = row(*src_id);
+			return std::binary_search(first, last, *dst_id);
+		}
+
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			return nodes_;
+		}
+
+		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
+			auto const src_id = id_of(src);
+			auto const dst_id = id_of(dst);
+			if (!src_id || !dst_id) {
+				throw std::runtime_error("Cannot call gdwg::csr_graph<N, E>::weights if src or dst "
+				                         "node don't exist in the graph");
+			}
+			auto [first, last] = row(*src_id);
+			auto [lower, upper] = std::equal_range(first, last, *dst_id);
+			return std::vector<E>(weights_.begin() + (lower - targets_.begin()),
+			                      weights_.begin() + (upper - targets_.begin()));
+		}
+
+		[[nodiscard]] auto find(N const& src, N const& dst, E const& weight) const -> iterator {
+			auto const src_id = id_of(src);
+			auto const dst_id = id_of(dst);
+			if (!src_id || !dst_id) {
+				return end();
+			}
+			auto [first, last] = row(*src_id);
+			auto [lower, upper] = std::equal_range(first, last, *dst_id);
+			auto const lower_edge = static_cast<std::size_t>(lower - targets_.begin());
+			auto const upper_edge = static_cast<std::size_t>(upper - targets_.begin());
+			auto it = std::lower_bound(weights_.begin() + static_cast<std::ptrdiff_t>(lower_edge),
+			                           weights_.begin() + static_cast<std::ptrdiff_t>(upper_edge),
+			                           weight);
+			auto const edge = static_cast<std::size_t>(it - weights_.begin());
+			if (edge == upper_edge || *it != weight) {
+				return end();
+			}
+			return iterator(this, *src_id, edge);
+		}
+
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			auto const src_id = id_of(src);
+			if (!src_id) {
+				throw std::runtime_error("Cannot call gdwg::csr_graph<N, E>::connections if src "
+				                         "doesn't exist in the graph");
+			}
+			auto [first, last] = row(*src_id);
+			std::vector<N> ret;
+			for (auto it = first; it != last; it++) {
+				if (it == first || *it != *(it - 1)) {
+					ret.push_back(nodes_[*it]);
+				}
+			}
+			return ret;
+		}
+
+		[[nodiscard]] auto operator==(csr_graph const& other) const -> bool = default;
+
+		friend auto operator<<(std::ostream& os, csr_graph const& g) -> std::ostream& {
+			for (auto from = std::size_t{0}; from < g.nodes_.size(); ++from) {
+				os << g.nodes_[from] << " (\n";
+				for (auto edge = g.offsets_[from]; edge < g.offsets_[from + 1]; ++edge) {
+					os << "  " << g.nodes_[g.targets_[edge]] << " | " << g.weights_[edge] << "\n";
+				}
+				os << ")\n";
+			}
+			return os;
+		}
+
+	private:
+		using target_iterator = typename std::vector<node_id>::const_iterator;
+
+		std::vector<N> nodes_;
+		std::vector<std::size_t> offsets_ = {0};
+		std::vector<node_id> targets_;
+		std::vector<E> weights_;
+
+		// Ids are positions in `nodes_`, so finding one is a binary search and nothing more.
+		[[nodiscard]] auto id_of(N const& value) const -> std::optional<node_id> {
+			auto it = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+			if (it == nodes_.end() || *it != value) {
+				return std::nullopt;
+			}
+			return static_cast<node_id>(it - nodes_.begin());
+		}
+
+		[[nodiscard]] auto row(node_id from) const -> std::pair<target_iterator, target_iterator> {
+			return {targets_.begin() + static_cast<std::ptrdiff_t>(offsets_[from]),
+			        targets_.begin() + static_cast<std::ptrdiff_t>(offsets_[from + 1])};
+		}
+
+		// The first row at or after `from` that has any edges, so iteration can skip empty rows.
+		[[nodiscard]] auto first_row_from(std::size_t from) const -> std::size_t {
+			while (from < nodes_.size() && offsets_[from + 1] == offsets_[from]) {
+				++from;
+			}
+			return from;
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_CSR_GRAPH_HPP
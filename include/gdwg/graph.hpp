@@ -2,64 +2,529 @@
 #define GDWG_GRAPH_HPP
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <map>
 #include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
+#include <ranges>
 #include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 // TODO: Make this graph generic
 //       ... this won't just compile
 //       straight away
 namespace gdwg {
-	template<typename N, typename E>
+	// Thrown when reading a graph from malformed text.
+	class parse_error : public std::runtime_error {
+	public:
+		parse_error(std::size_t line, std::string const& what)
+		: std::runtime_error("Cannot read a gdwg::graph<N, E>: line " + std::to_string(line) + ": "
+		                     + what)
+		, line_{line} {}
+
+		// The line of the input, counting from 1, that couldn't be read.
+		[[nodiscard]] auto line() const noexcept -> std::size_t {
+			return line_;
+		}
+
+	private:
+		std::size_t line_;
+	};
+
+	namespace detail {
+		struct graph_access;
+		struct graph_builder;
+
+		// Splits a stream into lines, reading it a block at a time straight from its buffer.
+		class line_reader {
+		public:
+			explicit line_reader(std::istream& is)
+			: is_{is} {}
+
+			// The next line, without its '\n', or nothing at the end of the input. The view is
+			// valid until the next call.
+			auto next() -> std::optional<std::string_view> {
+				auto scanned = pos_;
+				while (true) {
+					auto const newline = buffer_.find('\n', scanned);
+					if (newline != std::string::npos) {
+						auto const line = std::string_view(buffer_).substr(pos_, newline - pos_);
+						pos_ = newline + 1;
+						return line;
+					}
+					if (eof_) {
+						if (pos_ == buffer_.size()) {
+							return std::nullopt;
+						}
+						auto const line = std::string_view(buffer_).substr(pos_);
+						pos_ = buffer_.size();
+						return line;
+					}
+
+					buffer_.erase(0, pos_);
+					pos_ = 0;
+					scanned = buffer_.size();
+					buffer_.resize(scanned + block_size);
+					auto const read =
+					   is_.rdbuf() ? is_.rdbuf()->sgetn(buffer_.data() + scanned, block_size) : 0;
+					buffer_.resize(scanned + static_cast<std::size_t>(read));
+					if (read < block_size) {
+						eof_ = true;
+						is_.setstate(std::ios::eofbit);
+					}
+				}
+			}
+
+		private:
+			static constexpr auto block_size = std::streamsize{1} << 16;
+
+			std::istream& is_;
+			std::string buffer_;
+			std::size_t pos_ = 0;
+			bool eof_ = false;
+		};
+
+		template<typename T>
+		inline constexpr auto is_char_string = false;
+
+		template<typename Traits, typename A>
+		inline constexpr auto is_char_string<std::basic_string<char, Traits, A>> = true;
+
+		template<typename T>
+		inline constexpr auto is_char_type =
+		   std::is_same_v<T, char> || std::is_same_v<T, signed char>
+		   || std::is_same_v<T, unsigned char> || std::is_same_v<T, char8_t>
+		   || std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>
+		   || std::is_same_v<T, wchar_t>;
+
+		// Parses the whole of `text` as written by `operator<<`: strings verbatim, numbers with
+		// `std::from_chars`, and anything else with `operator>>`.
+		template<typename T>
+		auto parse_value(std::string_view text, T& out) -> bool {
+			if constexpr (is_char_string<T>) {
+				out.assign(text.begin(), text.end());
+				return true;
+			}
+			else if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>
+			                   && !is_char_type<T>) {
+				auto const last = text.data() + text.size();
+				auto const [end, error] = std::from_chars(text.data(), last, out);
+				return error == std::errc() && end == last;
+			}
+			else {
+				auto in = std::istringstream(std::string(text));
+				in >> out;
+				return !in.fail() && in.peek() == std::istringstream::traits_type::eof();
+			}
+		}
+
+		// The precision of a newly constructed stream.
+		constexpr auto default_precision = std::streamsize{6};
+
+		// Whether `os` formats values exactly as `text_formatter` does: no flags beyond the
+		// defaults, no field width, and the classic locale. Only the precision may vary.
+		inline auto has_default_format(std::ostream const& os) -> bool {
+			auto const formatting = os.flags() & ~(std::ios::skipws | std::ios::unitbuf);
+			return formatting == std::ios::dec && os.width() == 0
+			       && os.getloc() == std::locale::classic();
+		}
+
+		// Appends values to a buffer as `operator<<` on a default-formatted stream would: strings
+		// verbatim, numbers with `std::to_chars`, and anything else through a scratch stream.
+		class text_formatter {
+		public:
+			explicit text_formatter(std::streamsize precision)
+			: precision_{precision} {}
+
+			template<typename T>
+			auto append(std::string& out, T const& value) -> void {
+				if constexpr (is_char_string<T>) {
+					out.append(value.data(), value.size());
+					return;
+				}
+				else if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>
+				                   && !is_char_type<T>) {
+					auto chars = std::array<char, 128>();
+					auto const [end, error] = [&] {
+						if constexpr (std::is_floating_point_v<T>) {
+							return std::to_chars(chars.begin(),
+							                     chars.end(),
+							                     value,
+							                     std::chars_format::general,
+							                     static_cast<int>(precision_));
+						}
+						else {
+							return std::to_chars(chars.begin(), chars.end(), value);
+						}
+					}();
+					if (error == std::errc()) {
+						out.append(chars.data(), end);
+						return;
+					}
+				}
+				if (!scratch_) {
+					scratch_.emplace();
+					scratch_->precision(precision_);
+				}
+				scratch_->str({});
+				*scratch_ << value;
+				out.append(scratch_->view());
+			}
+
+		private:
+			std::streamsize precision_;
+			std::optional<std::ostringstream> scratch_;
+		};
+
+		template<typename T>
+		concept hashable = requires(T const& value) {
+			{ std::hash<T>{}(value) } -> std::convertible_to<std::size_t>;
+		};
+
+		// Spreads the bits of a hash (std::hash is the identity for integers) and keeps it non-zero,
+		// since `flat_table` uses zero to mark an empty slot.
+		constexpr auto mix_hash(std::uint64_t h) -> std::size_t {
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdULL;
+			h ^= h >> 33;
+			h *= 0xc4ceb9fe1a85ec53ULL;
+			h ^= h >> 33;
+			return h == 0 ? 1 : static_cast<std::size_t>(h);
+		}
+
+		// An open-addressing hash table with linear probing. Each slot keeps its entry's hash next
+		// to the entry, so a probe only looks at an entry whose hash matches, and erasing shifts
+		// later entries back rather than leaving tombstones. The caller hashes entries and says
+		// which one it is looking for, so entries need no key of their own.
+		template<typename T, typename Allocator>
+		class flat_table {
+		public:
+			explicit flat_table(Allocator const& alloc)
+			: slots_(alloc) {}
+
+			[[nodiscard]] auto size() const -> std::size_t {
+				return size_;
+			}
+
+			// The entry with hash `hash` for which `match` is true, or null.
+			template<typename Match>
+			[[nodiscard]] auto find(std::size_t hash, Match match) const -> T const* {
+				auto const i = find_slot(hash, match);
+				return i == npos ? nullptr : &slots_[i].value;
+			}
+
+			template<typename Match>
+			[[nodiscard]] auto find(std::size_t hash, Match match) -> T* {
+				auto const i = find_slot(hash, match);
+				return i == npos ? nullptr : &slots_[i].value;
+			}
+
+			// Adds an entry that isn't in the table yet.
+			auto insert(std::size_t hash, T value) -> void {
+				if ((size_ + 1) * 4 > slots_.size() * 3) {
+					rehash(std::max(slots_.size() * 2, std::size_t{16}));
+				}
+				place(hash, std::move(value));
+				++size_;
+			}
+
+			template<typename Match>
+			auto erase(std::size_t hash, Match match) -> void {
+				auto hole = find_slot(hash, match);
+				if (hole == npos) {
+					return;
+				}
+				for (auto i = (hole + 1) & mask(); slots_[i].hash != 0; i = (i + 1) & mask()) {
+					// An entry can fill the hole if its probe sequence passes through it.
+					auto const home = slots_[i].hash & mask();
+					if (((i - home) & mask()) >= ((i - hole) & mask())) {
+						slots_[hole] = std::move(slots_[i]);
+						hole = i;
+					}
+				}
+				slots_[hole] = slot{};
+				--size_;
+			}
+
+			auto clear() noexcept -> void {
+				slots_.clear();
+				size_ = 0;
+			}
+
+			auto swap(flat_table& other) noexcept -> void {
+				slots_.swap(other.slots_);
+				std::swap(size_, other.size_);
+			}
+
+		private:
+			struct slot {
+				T value{};
+				std::size_t hash = 0;
+			};
+
+			std::vector<slot, typename std::allocator_traits<Allocator>::template rebind_alloc<slot>>
+			   slots_;
+			std::size_t size_ = 0;
+
+			static constexpr auto npos = static_cast<std::size_t>(-1);
+
+			auto mask() const -> std::size_t {
+				return slots_.size() - 1;
+			}
+
+			template<typename Match>
+			auto find_slot(std::size_t hash, Match& match) const -> std::size_t {
+				if (slots_.empty()) {
+					return npos;
+				}
+				for (auto i = hash & mask();; i = (i + 1) & mask()) {
+					auto const& candidate = slots_[i];
+					if (candidate.hash == 0) {
+						return npos;
+					}
+					if (candidate.hash == hash && match(candidate.value)) {
+						return i;
+					}
+				}
+			}
+
+			auto place(std::size_t hash, T value) -> void {
+				auto i = hash & mask();
+				while (slots_[i].hash != 0) {
+					i = (i + 1) & mask();
+				}
+				slots_[i] = slot{std::move(value), hash};
+			}
+
+			auto rehash(std::size_t capacity) -> void {
+				auto old = std::move(slots_);
+				slots_ = decltype(slots_)(capacity, old.get_allocator());
+				for (auto& entry : old) {
+					if (entry.hash != 0) {
+						place(entry.hash, std::move(entry.value));
+					}
+				}
+			}
+		};
+	} // namespace detail
+
+	// Whether a graph keeps a list of the incoming edges of every node. With it, anything keyed on
+	// an edge's destination (`in_edges`, `predecessors`, `in_degree`, and the incoming half of
+	// erasing or merging a node) costs O(log E + k). Without it those scan every edge, but inserting
+	// and erasing edges does less work and each edge takes less memory.
+	enum class in_edge_index { enabled, disabled };
+
+	// How a graph finds a node by value. `ordered` uses only the sorted node index, so every lookup
+	// is O(log V) comparisons. `hashed` also keeps flat hash tables from each node to its entry and
+	// from each (src, dst) pair to its edges, so `is_node`, `is_connected` and the lookups that
+	// start every other operation are O(1) expected, at the cost of the tables' memory and of
+	// keeping them up to date. Iteration and output stay in sorted order either way. `hashed`
+	// needs `std::hash<N>`.
+	enum class node_lookup { ordered, hashed };
+
+	// `Allocator` is rebound for every piece of the graph's storage: the node index, the node
+	// table, the edge set and each node's incoming-edge list. With `gdwg::pmr::graph` the whole
+	// graph can be placed in one memory resource, such as a per-request arena.
+	//
+	// Every query is a const member, and none of them changes the graph or allocates anything but
+	// the container it returns. Any number of threads can therefore query one graph at once, as
+	// long as nothing modifies it meanwhile; see gdwg/concurrent_graph.hpp for a graph that can
+	// also be written while it is read.
+	template<typename N, typename E, typename Allocator = std::allocator<N>>
 	class graph {
 	public:
-		struct edge;
-		struct node;
+		// Every node is interned once and referred to by a small integer id everywhere else. Ids
+		// are dense: an erased node's id is handed to the next node inserted.
+		using node_id = std::uint32_t;
+
+		// The most nodes a graph can hold. The largest node_id is kept back so algorithms can use
+		// it to mean "no node"; inserting a node beyond this throws `std::length_error`.
+		static constexpr auto max_nodes = std::size_t{std::numeric_limits<node_id>::max()};
+
 		struct value_type {
 			N from;
 			N to;
 			E weight;
 		};
 
+		// What an iterator points to: the same fields as `value_type`, but referring to the values
+		// stored in the graph instead of copying them. Convert to `value_type` for a copy.
+		struct reference {
+			N const& from;
+			N const& to;
+			E const& weight;
+
+			operator value_type() const {
+				return value_type{from, to, weight};
+			}
+		};
+
+		using allocator_type = Allocator;
+
+	private:
+		using alloc_traits = std::allocator_traits<Allocator>;
+		template<typename T>
+		using allocator_for = typename alloc_traits::template rebind_alloc<T>;
+
+		struct node;
+		using node_table = std::vector<node, allocator_for<node>>;
+
+		// Edges refer to their endpoints by id, so two endpoints are the same node exactly when
+		// their ids are equal. N is only read back when two different nodes have to be ordered.
+		struct edge {
+			node_id from;
+			node_id to;
+			E weight;
+		};
+
+		// Lookup keys for the edge set. An `endpoints_key` matches every edge between two nodes, so
+		// `equal_range` picks out that slice.
+		struct edge_key {
+			node_id from;
+			node_id to;
+			E const& weight;
+		};
+
+		struct endpoints_key {
+			node_id from;
+			node_id to;
+		};
+
+		// Orders edges by (from, to, weight), comparing the interned values of different nodes so
+		// that edges iterate in value order.
+		struct edge_less {
+			using is_transparent = void;
+
+			node_table const* nodes;
+
+			auto operator()(edge const& lhs, edge const& rhs) const -> bool {
+				return less(lhs.from, lhs.to, lhs.weight, rhs.from, rhs.to, rhs.weight);
+			}
+			auto operator()(edge const& lhs, edge_key const& rhs) const -> bool {
+				return less(lhs.from, lhs.to, lhs.weight, rhs.from, rhs.to, rhs.weight);
+			}
+			auto operator()(edge_key const& lhs, edge const& rhs) const -> bool {
+				return less(lhs.from, lhs.to, lhs.weight, rhs.from, rhs.to, rhs.weight);
+			}
+			auto operator()(edge const& lhs, endpoints_key const& rhs) const -> bool {
+				return less(lhs.from, lhs.to, rhs.from, rhs.to);
+			}
+			auto operator()(endpoints_key const& lhs, edge const& rhs) const -> bool {
+				return less(lhs.from, lhs.to, rhs.from, rhs.to);
+			}
+
+		private:
+			auto less(node_id lhs, node_id rhs) const -> bool {
+				return lhs != rhs && *(*nodes)[lhs].value < *(*nodes)[rhs].value;
+			}
+
+			auto less(node_id lhs_from, node_id lhs_to, node_id rhs_from, node_id rhs_to) const
+			   -> bool {
+				if (lhs_from != rhs_from) {
+					return less(lhs_from, rhs_from);
+				}
+				return less(lhs_to, rhs_to);
+			}
+
+			auto less(node_id lhs_from,
+			          node_id lhs_to,
+			          E const& lhs_weight,
+			          node_id rhs_from,
+			          node_id rhs_to,
+			          E const& rhs_weight) const -> bool {
+				if (lhs_from != rhs_from) {
+					return less(lhs_from, rhs_from);
+				}
+				if (lhs_to != rhs_to) {
+					return less(lhs_to, rhs_to);
+				}
+				return lhs_weight < rhs_weight;
+			}
+		};
+
+		using edge_set = std::set<edge, edge_less, allocator_for<edge>>;
+		using edge_iterator = typename edge_set::const_iterator;
+		using node_index =
+		   std::map<N, node_id, std::less<>, allocator_for<std::pair<N const, node_id>>>;
+
+		// Orders the edges coming into a node by the id of their source, then by weight.
+		struct in_edge_less {
+			auto operator()(edge_iterator lhs, edge_iterator rhs) const -> bool {
+				if (lhs->from != rhs->from) {
+					return lhs->from < rhs->from;
+				}
+				return lhs->weight < rhs->weight;
+			}
+		};
+
+		struct node {
+			explicit node(allocator_for<edge_iterator> const& alloc)
+			: in{alloc} {}
+
+			// The node's value, owned by its entry in `index_`. Null while the id is unused.
+			N const* value = nullptr;
+			// The edges leaving this node are the contiguous run of `edges_` that starts at
+			// `out_first` and is `out_degree` edges long, so they need no list of their own.
+			edge_iterator out_first;
+			std::size_t out_degree = 0;
+			// The edges ending at this node.
+			std::set<edge_iterator, in_edge_less, allocator_for<edge_iterator>> in;
+		};
+
+		using out_range = std::ranges::subrange<std::counted_iterator<edge_iterator>,
+		                                        std::default_sentinel_t>;
+
+		// Frees the node table through the graph's allocator.
+		struct table_deleter {
+			allocator_for<node_table> alloc;
+
+			auto operator()(node_table* table) -> void {
+				std::destroy_at(table);
+				std::allocator_traits<allocator_for<node_table>>::deallocate(alloc, table, 1);
+			}
+		};
+
+		using table_ptr = std::unique_ptr<node_table, table_deleter>;
+
+	public:
 		class iterator {
-			using edge_t = typename std::set<edge>::const_iterator;
+			using edge_t = edge_iterator;
 
 		public:
-			using value_type = graph<N, E>::value_type;
-			using reference = value_type;
+			using value_type = graph::value_type;
+			using reference = graph::reference;
 			using pointer = void;
 			using difference_type = std::ptrdiff_t;
 			using iterator_category = std::bidirectional_iterator_tag;
 
 			// Iterator constructor
 			iterator() = default;
-			explicit iterator(N const& src, N const& dst, E const& weight, std::set<edge> edges) {
-				struct edge findEdge;
-				findEdge.from = std::make_shared<N>(src);
-				findEdge.to = std::make_shared<N>(dst);
-				findEdge.weight = weight;
-
-				auto it = edges.find(findEdge);
-				if (it != edges.end()) {
-					data_ = it;
-					std::cout << *(data_->from) << " " << *(data_->to) << " " << data_->weight << "\n";
-				}
-				else {
-					data_ = edges.end();
-					std::cout << "AAA\n";
-				}
-			}
 
 			// Iterator source
-			auto operator*() -> reference {
-				struct graph<N, E>::value_type ret;
-				ret.from = *(data_->from);
-				ret.to = *(data_->to);
-				ret.weight = data_->weight;
-
-				return ret;
+			auto operator*() const -> reference {
+				return reference{*(*nodes_)[data_->from].value,
+				                 *(*nodes_)[data_->to].value,
+				                 data_->weight};
 			}
 
 			// Iterator traversal
@@ -90,101 +555,183 @@ namespace gdwg {
 
 		private:
 			edge_t data_;
+			node_table const* nodes_ = nullptr;
 
-			iterator(edge_t begin)
-			: data_{begin} {}
+			iterator(edge_t begin, node_table const* nodes)
+			: data_{begin}
+			, nodes_{nodes} {}
 
 			friend class graph;
 		};
 
-		[[nodiscard]] auto begin() const -> iterator {
-			return iterator(edges.begin());
-		}
-
-		[[nodiscard]] auto end() const -> iterator {
-			return iterator(edges.end());
-		}
+		// Walks the distinct destinations of one node's outgoing edges, stepping over parallel
+		// edges to the same node.
+		class neighbor_iterator {
+		public:
+			using value_type = N;
+			using reference = N const&;
+			using difference_type = std::ptrdiff_t;
+			using iterator_category = std::forward_iterator_tag;
 
-		struct edge {
-			std::shared_ptr<N> from;
-			std::shared_ptr<N> to;
-			E weight;
+			neighbor_iterator() = default;
 
-			bool operator<(const edge& rhs) const {
-				if (*from != *(rhs.from)) {
-					return *from < *(rhs.from);
-				}
-				else if (*to != *(rhs.to)) {
-					return *to < *(rhs.to);
-				}
-				else {
-					return weight < rhs.weight;
-				}
+			auto operator*() const -> reference {
+				return *(*nodes_)[edge_->to].value;
 			}
 
-			bool operator==(const edge& rhs) const {
-				return *from == *(rhs.from) && *to == *(rhs.to) && weight == rhs.weight;
+			auto operator++() -> neighbor_iterator& {
+				auto const to = edge_->to;
+				do {
+					++edge_;
+					--remaining_;
+				} while (remaining_ > 0 && edge_->to == to);
+				return *this;
+			}
+			auto operator++(int) -> neighbor_iterator {
+				auto old = *this;
+				++*(this);
+				return old;
 			}
-		};
-
-		struct node {
-			std::shared_ptr<N> value;
 
-			bool operator<(const node& rhs) const {
-				return *value < *(rhs.value);
+			auto operator==(neighbor_iterator const& other) const -> bool {
+				return remaining_ == other.remaining_ && (remaining_ == 0 || edge_ == other.edge_);
 			}
 
-			bool operator==(const node& rhs) const {
-				return *value == *(rhs.value);
+			friend auto operator==(neighbor_iterator const& it, std::default_sentinel_t) -> bool {
+				return it.remaining_ == 0;
 			}
+
+		private:
+			edge_iterator edge_;
+			std::size_t remaining_ = 0;
+			node_table const* nodes_ = nullptr;
+
+			neighbor_iterator(edge_iterator first, std::size_t count, node_table const* nodes)
+			: edge_{first}
+			, remaining_{count}
+			, nodes_{nodes} {}
+
+			friend class graph;
 		};
 
-		graph() = default;
+		using edge_range = std::ranges::subrange<iterator>;
+		using out_edge_range =
+		   std::ranges::subrange<std::counted_iterator<iterator>, std::default_sentinel_t>;
+		using neighbor_range = std::ranges::subrange<neighbor_iterator, std::default_sentinel_t>;
+
+		[[nodiscard]] auto begin() const -> iterator {
+			return iterator(edges_.begin(), nodes_.get());
+		}
+
+		[[nodiscard]] auto end() const -> iterator {
+			return iterator(edges_.end(), nodes_.get());
+		}
+
+		graph()
+		: graph(Allocator()) {}
+
+		explicit graph(Allocator const& alloc)
+		: alloc_{alloc} {}
+
+		explicit graph(in_edge_index index, Allocator const& alloc = Allocator())
+		: alloc_{alloc}
+		, in_index_{index} {}
 
-		graph(std::initializer_list<N> il)
-		: graph(il.begin(), il.end()) {}
+		explicit graph(node_lookup lookup, Allocator const& alloc = Allocator())
+		requires detail::hashable<N>
+		: alloc_{alloc}
+		, lookup_{lookup} {}
+
+		graph(in_edge_index index, node_lookup lookup, Allocator const& alloc = Allocator())
+		requires detail::hashable<N>
+		: alloc_{alloc}
+		, in_index_{index}
+		, lookup_{lookup} {}
+
+		graph(std::initializer_list<N> il, Allocator const& alloc = Allocator())
+		: graph(il.begin(), il.end(), alloc) {}
 
 		template<typename InputIt>
-		graph(InputIt first, InputIt last) {
+		graph(InputIt first, InputIt last, Allocator const& alloc = Allocator())
+		: graph(alloc) {
 			for (auto it = first; it != last; it++) {
 				insert_node(*it);
 			}
 		}
 
-		graph(graph&& other) noexcept {
-			this->nodes_.clear();
-			this->edges.clear();
-			std::swap(this->nodes_, other.nodes_);
-			std::swap(this->edges, other.edges);
+		// A moved-from graph is left empty and without a node table; `insert_node` gives it a new
+		// one, so moving never has to allocate.
+		graph(graph&& other) noexcept
+		: alloc_{other.alloc_}
+		, index_{std::move(other.index_)}
+		, nodes_{std::move(other.nodes_)}
+		, free_ids_{std::move(other.free_ids_)}
+		, edges_{std::move(other.edges_)}
+		, in_index_{other.in_index_}
+		, lookup_{other.lookup_}
+		, hashed_nodes_{std::move(other.hashed_nodes_)}
+		, hashed_edges_{std::move(other.hashed_edges_)} {
+			other.index_.clear();
+			other.free_ids_.clear();
+			other.edges_.clear();
+			other.hashed_nodes_.clear();
+			other.hashed_edges_.clear();
 		}
 
-		graph(graph& other) noexcept {
-			this->nodes_.clear();
-			this->edges.clear();
-			for (auto const& it : other.nodes_) {
-				insert_node(*(it.value));
+		graph(graph const& other)
+		: graph(other, alloc_traits::select_on_container_copy_construction(other.alloc_)) {}
+
+		// Copies are built in one ordered pass. Ids carry over unchanged, so edges are copied as
+		// they are and appended at the end of the edge set, and nothing is looked up by value.
+		graph(graph const& other, Allocator const& alloc)
+		: alloc_{alloc}
+		, index_{other.index_, typename node_index::allocator_type(alloc)}
+		, free_ids_{other.free_ids_, allocator_for<node_id>(alloc)}
+		, in_index_{other.in_index_}
+		, lookup_{other.lookup_} {
+			auto const size = other.nodes_ ? other.nodes_->size() : 0;
+			nodes_->reserve(size);
+			for (auto i = std::size_t{0}; i < size; ++i) {
+				nodes_->emplace_back(allocator_for<edge_iterator>(alloc_));
+			}
+			for (auto it = index_.begin(); it != index_.end(); ++it) {
+				(*nodes_)[it->second].value = &it->first;
+				if (hashed()) {
+					hashed_nodes_.insert(node_hash(it->first), it);
+				}
 			}
-			for (auto const& it : other.edges) {
-				insert_edge(*(it.from), *(it.to), it.weight);
+			for (auto const& it : other.edges_) {
+				link(edges_.insert(edges_.end(), it));
 			}
 		}
 
-		auto operator=(graph&& other) noexcept -> graph& {
-			this->nodes_.clear();
-			this->edges.clear();
-			std::swap(this->nodes_, other.nodes_);
-			std::swap(this->edges, other.edges);
+		// Storage can only change hands between graphs whose allocators are interchangeable; a
+		// graph with a different memory resource gets a copy instead.
+		auto operator=(graph&& other) noexcept(alloc_traits::is_always_equal::value) -> graph& {
+			if (alloc_traits::is_always_equal::value || alloc_ == other.alloc_) {
+				index_.swap(other.index_);
+				// Allocators that aren't assignable (like polymorphic_allocator) can't be swapped
+				// along with the tables, but since the two are equal either deleter will do.
+				auto* table = nodes_.release();
+				nodes_.reset(other.nodes_.release());
+				other.nodes_.reset(table);
+				free_ids_.swap(other.free_ids_);
+				edges_.swap(other.edges_);
+				std::swap(in_index_, other.in_index_);
+				std::swap(lookup_, other.lookup_);
+				hashed_nodes_.swap(other.hashed_nodes_);
+				hashed_edges_.swap(other.hashed_edges_);
+			}
+			else {
+				*this = graph(other, alloc_);
+			}
+			other.clear();
 			return *this;
 		}
 
 		auto operator=(graph const& other) -> graph& {
-			this->nodes_.clear();
-			this->edges.clear();
-			for (auto const& it : other.nodes_) {
-				insert_node(*(it.value));
-			}
-			for (auto const& it : other.edges) {
-				insert_edge(*(it.from), *(it.to), it.weight);
+			if (this != &other) {
+				*this = graph(other, alloc_);
 			}
 			return *this;
 		}
@@ -192,39 +739,129 @@ namespace gdwg {
 		~graph() noexcept = default;
 
 		auto insert_node(N const& value) -> bool {
-			struct node newNode;
-			newNode.value = std::make_shared<N>(value);
-			return nodes_.insert(newNode).second;
+			if (is_node(value)) {
+				return false;
+			}
+			if (!nodes_) {
+				nodes_.reset(make_table(alloc_).release());
+				edges_ = edge_set(edge_less{nodes_.get()}, allocator_for<edge>(alloc_));
+			}
+
+			auto const reuse = !free_ids_.empty();
+			if (!reuse && nodes_->size() >= max_nodes) {
+				throw std::length_error("Cannot call gdwg::graph<N, E>::insert_node on a graph that "
+				                        "already has the most nodes a node_id can number");
+			}
+			auto const id = reuse ? free_ids_.back() : static_cast<node_id>(nodes_->size());
+			if (!reuse) {
+				nodes_->emplace_back(allocator_for<edge_iterator>(alloc_));
+			}
+			auto it = index_.emplace(value, id).first;
+			if (reuse) {
+				free_ids_.pop_back();
+			}
+			(*nodes_)[id].value = &it->first;
+			if (hashed()) {
+				hashed_nodes_.insert(node_hash(value), it);
+			}
+			return true;
 		}
 
 		auto insert_edge(N const& src, N const& dst, E const& weight) -> bool {
-			if (!is_node(src) || !is_node(dst)) {
+			auto srcNode = find_node(src);
+			auto dstNode = find_node(dst);
+			if (srcNode == index_.end() || dstNode == index_.end()) {
 				throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src "
 				                         "or dst node does not exist");
 			}
-			struct node findNode;
-			findNode.value = std::make_shared<N>(src);
-			auto srcNode = nodes_.find(findNode);
-
-			struct node findNode2;
-			findNode2.value = std::make_shared<N>(dst);
-			auto dstNode = nodes_.find(findNode2);
-
-			struct edge newEdge;
-			newEdge.from = srcNode->value;
-			newEdge.to = dstNode->value;
-			newEdge.weight = weight;
+			return insert_edge(srcNode->second, dstNode->second, weight);
+		}
 
-			bool edgeUnique = edges.insert(newEdge).second;
-			if (!edgeUnique) {
-				return false;
+		// Inserts a batch of edges at once and returns how many of them were new. The batch is
+		// sorted and deduplicated up front, and the edges are then added in order so every
+		// insertion lands at its hint. Endpoints are looked up one at a time, unless the batch is
+		// big enough next to the graph that one merge against the (sorted) nodes is cheaper. If any
+		// endpoint is missing, nothing is inserted.
+		template<typename InputIt>
+		auto insert_edges(InputIt first, InputIt last) -> std::size_t {
+			auto batch = std::vector<value_type>(first, last);
+			auto const value_less = [](value_type const& lhs, value_type const& rhs) {
+				if (lhs.from != rhs.from) {
+					return lhs.from < rhs.from;
+				}
+				if (lhs.to != rhs.to) {
+					return lhs.to < rhs.to;
+				}
+				return lhs.weight < rhs.weight;
+			};
+			std::sort(batch.begin(), batch.end(), value_less);
+			batch.erase(std::unique(batch.begin(),
+			                        batch.end(),
+			                        [](value_type const& lhs, value_type const& rhs) {
+				                        return lhs.from == rhs.from && lhs.to == rhs.to
+				                               && lhs.weight == rhs.weight;
+			                        }),
+			            batch.end());
+
+			auto srcs = std::vector<node_id>(batch.size());
+			auto dsts = std::vector<node_id>(batch.size());
+			auto const missing = [] {
+				return std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edges when either "
+				                          "src or dst node does not exist");
+			};
+
+			// A merge walks all V nodes, while looking up both endpoints of B edges costs about
+			// 2B log V comparisons.
+			auto const merge_cost = index_.size();
+			auto const lookup_cost =
+			   batch.size() * 2 * static_cast<std::size_t>(std::bit_width(index_.size()));
+			if (lookup_cost < merge_cost) {
+				for (auto i = std::size_t{0}; i < batch.size(); ++i) {
+					auto const srcNode = find_node(batch[i].from);
+					auto const dstNode = find_node(batch[i].to);
+					if (srcNode == index_.end() || dstNode == index_.end()) {
+						throw missing();
+					}
+					srcs[i] = srcNode->second;
+					dsts[i] = dstNode->second;
+				}
+				return insert_resolved(batch, srcs, dsts);
 			}
 
-			return true;
+			auto resolve = [this, &missing](auto const& order, auto const& value_of, auto& out) {
+				auto node_it = index_.begin();
+				for (auto i : order) {
+					auto const& value = value_of(i);
+					while (node_it != index_.end() && node_it->first < value) {
+						++node_it;
+					}
+					if (node_it == index_.end() || node_it->first != value) {
+						throw missing();
+					}
+					out[i] = node_it->second;
+				}
+			};
+
+			// Sources are already in order; destinations need an order of their own to merge.
+			auto order = std::vector<std::size_t>(batch.size());
+			std::iota(order.begin(), order.end(), std::size_t{0});
+			resolve(order, [&batch](std::size_t i) -> N const& { return batch[i].from; }, srcs);
+			std::stable_sort(order.begin(), order.end(), [&batch](std::size_t lhs, std::size_t rhs) {
+				return batch[lhs].to < batch[rhs].to;
+			});
+			resolve(order, [&batch](std::size_t i) -> N const& { return batch[i].to; }, dsts);
+			return insert_resolved(batch, srcs, dsts);
+		}
+
+		auto insert_edges(std::initializer_list<value_type> il) -> std::size_t {
+			return insert_edges(il.begin(), il.end());
 		}
 
+		// Renames the node in place: its index entry is re-keyed and its edges are taken out and
+		// put back in their new order, all without reallocating, in O(degree * log E).
 		auto replace_node(N const& old_data, N const& new_data) -> bool {
-			if (!is_node(old_data)) {
+			auto oldNode = find_node(old_data);
+			if (oldNode == index_.end()) {
 				throw std::runtime_error("Cannot call gdwg::graph<N, E>::replace_node on a node that "
 				                         "doesn't exist");
 			}
@@ -232,121 +869,68 @@ namespace gdwg {
 				return false;
 			}
 
-			insert_node(new_data);
-
-			merge_replace_node(old_data, new_data);
+			auto key = N(new_data);
+			auto const id = oldNode->second;
+			auto edges = detach_incident_edges(id);
+			forget_node(oldNode);
+			auto handle = index_.extract(oldNode);
+			handle.key() = std::move(key);
+			auto const newNode = index_.insert(std::move(handle)).position;
+			(*nodes_)[id].value = &newNode->first;
+			if (hashed()) {
+				hashed_nodes_.insert(node_hash(newNode->first), newNode);
+			}
+			reattach_edges(edges, id, id);
 			return true;
 		}
 
+		// Only the edges touching the old node move: they are taken out of the graph, pointed at
+		// the new node and put back, dropping any that duplicate an edge the new node already has.
+		// O(degree * log E), without reallocating the edges.
 		auto merge_replace_node(N const& old_data, N const& new_data) -> void {
-			if (!is_node(old_data) || !is_node(new_data)) {
+			auto oldNode = find_node(old_data);
+			auto newNode = find_node(new_data);
+			if (oldNode == index_.end() || newNode == index_.end()) {
 				throw std::runtime_error("Cannot call gdwg::graph<N, E>::merge_replace_node on old or "
 				                         "new data if they don't exist in the graph");
 			}
-
-			struct node findNode;
-			findNode.value = std::make_shared<N>(old_data);
-			auto oldNode = nodes_.find(findNode);
-
-			struct node findNode2;
-			findNode2.value = std::make_shared<N>(new_data);
-			auto newNode = nodes_.find(findNode2);
-
-			std::set<std::tuple<N, E>> froms;
-
-			for (auto it = edges.begin(); it != edges.end();) {
-				if (it->from == newNode->value || it->to == newNode->value) {
-					it = edges.erase(it);
-				}
-				else {
-					++it;
-				}
-			}
-
-			for (auto it = edges.begin(); it != edges.end();) {
-				if (it->from == oldNode->value) {
-					froms.insert(make_tuple(*(it->to), it->weight));
-					it = edges.erase(it);
-				}
-				else {
-					++it;
-				}
-			}
-
-			for (auto const& it : froms) {
-				insert_edge(*(newNode->value), get<0>(it), get<1>(it));
+			if (oldNode == newNode) {
+				return;
 			}
 
-			std::set<std::tuple<N, E>> tos;
-
-			for (auto it = edges.begin(); it != edges.end();) {
-				if (it->to == oldNode->value) {
-					tos.insert(make_tuple(*(it->from), it->weight));
-					it = edges.erase(it);
-				}
-				else {
-					++it;
-				}
-			}
-
-			for (auto const& it : tos) {
-				insert_edge(get<0>(it), *(newNode->value), get<1>(it));
-			}
-
-			nodes_.erase(oldNode);
+			auto edges = detach_incident_edges(oldNode->second);
+			reattach_edges(edges, oldNode->second, newNode->second);
+			erase_node_at(oldNode);
 		}
 
 		auto erase_node(N const& value) -> bool {
-			if (!is_node(value)) {
+			auto oldNode = find_node(value);
+			if (oldNode == index_.end()) {
 				return false;
 			}
 
-			struct node findNode;
-			findNode.value = std::make_shared<N>(value);
-			auto oldNode = nodes_.find(findNode);
-
-			for (auto it = edges.begin(); it != edges.end();) {
-				if (it->from == oldNode->value || it->to == oldNode->value) {
-					it = edges.erase(it);
-				}
-				else {
-					++it;
-				}
-			}
-
-			nodes_.erase(oldNode);
+			erase_incident_edges(oldNode->second);
+			erase_node_at(oldNode);
 			return true;
 		}
 
 		auto erase_edge(N const& src, N const& dst, E const& weight) -> bool {
-			if (!is_node(src) || !is_node(dst)) {
+			auto srcNode = find_node(src);
+			auto dstNode = find_node(dst);
+			if (srcNode == index_.end() || dstNode == index_.end()) {
 				throw std::runtime_error("Cannot call gdwg::graph<N, E>::erase_edge on src or dst if "
 				                         "they don't exist in the graph");
 			}
-			struct edge findEdge;
-			findEdge.from = std::make_shared<N>(src);
-			findEdge.to = std::make_shared<N>(dst);
-			findEdge.weight = weight;
-
-			auto it = edges.find(findEdge);
-			if (it != edges.end()) {
-				edges.erase(it);
+			auto it = edges_.find(edge_key{srcNode->second, dstNode->second, weight});
+			if (it != edges_.end()) {
+				erase_edge_at(it);
 				return true;
 			}
 			return false;
 		}
 
 		auto erase_edge(iterator i) -> iterator {
-			auto ret = i++;
-			struct edge findEdge;
-			auto [from, to, weight] = *ret;
-			findEdge.from = std::make_shared<N>(from);
-			findEdge.to = std::make_shared<N>(to);
-			findEdge.weight = weight;
-
-			auto it = edges.find(findEdge);
-			edges.erase(it);
-			return i;
+			return iterator(erase_edge_at(i.data_), nodes_.get());
 		}
 
 		auto erase_edge(iterator i, iterator s) -> iterator {
@@ -359,141 +943,989 @@ namespace gdwg {
 		}
 
 		auto clear() noexcept -> void {
-			nodes_.clear();
-			edges.clear();
+			hashed_edges_.clear();
+			hashed_nodes_.clear();
+			edges_.clear();
+			index_.clear();
+			free_ids_.clear();
+			if (nodes_) {
+				nodes_->clear();
+			}
 		}
 
-		[[nodiscard]] auto is_node(N const& value) -> bool {
-			struct node findNode;
-			findNode.value = std::make_shared<N>(value);
-			auto it = nodes_.find(findNode);
-			if (it != nodes_.end()) {
-				return true;
+		// Buffers a set of changes and applies them to the graph together on `commit`. Changes are
+		// grouped by kind rather than applied in the order they were made: first new nodes, then
+		// node replacements and merges (in the order they were made), then erased edges, then
+		// erased nodes, and new edges last. The other groups are sorted and deduplicated, erased
+		// nodes lose their edges in one sweep, and new edges go through `insert_edges`.
+		//
+		// Every change is checked before any is made, so if `commit` throws the graph is left as it
+		// was. Changes that are never committed are discarded.
+		class transaction {
+		public:
+			transaction(transaction&&) noexcept = default;
+			auto operator=(transaction&&) noexcept -> transaction& = default;
+			~transaction() = default;
+
+			auto insert_node(N const& value) -> transaction& {
+				inserted_nodes_.push_back(value);
+				return *this;
 			}
-			return false;
+
+			auto insert_edge(N const& src, N const& dst, E const& weight) -> transaction& {
+				inserted_edges_.push_back(value_type{src, dst, weight});
+				return *this;
+			}
+
+			// Like `graph::replace_node`: `old_data` must exist once this transaction's new nodes
+			// are added, and nothing happens if `new_data` already exists by then.
+			auto replace_node(N const& old_data, N const& new_data) -> transaction& {
+				replaced_nodes_.push_back({old_data, new_data, false});
+				return *this;
+			}
+
+			// Like `graph::merge_replace_node`: both nodes must exist once this transaction's new
+			// nodes are added.
+			auto merge_replace_node(N const& old_data, N const& new_data) -> transaction& {
+				replaced_nodes_.push_back({old_data, new_data, true});
+				return *this;
+			}
+
+			auto erase_node(N const& value) -> transaction& {
+				erased_nodes_.push_back(value);
+				return *this;
+			}
+
+			auto erase_edge(N const& src, N const& dst, E const& weight) -> transaction& {
+				erased_edges_.push_back(value_type{src, dst, weight});
+				return *this;
+			}
+
+			auto commit() -> void {
+				prepare();
+				validate();
+
+				auto& g = *graph_;
+				for (auto const& value : inserted_nodes_) {
+					g.insert_node(value);
+				}
+				for (auto const& [old_data, new_data, merge] : replaced_nodes_) {
+					if (merge) {
+						g.merge_replace_node(old_data, new_data);
+					}
+					else {
+						g.replace_node(old_data, new_data);
+					}
+				}
+				for (auto const& [src, dst, weight] : erased_edges_) {
+					g.erase_edge(src, dst, weight);
+				}
+				g.erase_nodes(erased_nodes_);
+				g.insert_edges(std::make_move_iterator(inserted_edges_.begin()),
+				               std::make_move_iterator(inserted_edges_.end()));
+				clear();
+			}
+
+		private:
+			struct replacement {
+				N old_data;
+				N new_data;
+				bool merge;
+			};
+
+			graph* graph_;
+			std::vector<N> inserted_nodes_;
+			std::vector<replacement> replaced_nodes_;
+			std::vector<value_type> erased_edges_;
+			std::vector<N> erased_nodes_;
+			std::vector<value_type> inserted_edges_;
+
+			explicit transaction(graph& g)
+			: graph_{&g} {}
+
+			static auto sort_unique(auto& values, auto less, auto equal) -> void {
+				std::sort(values.begin(), values.end(), less);
+				values.erase(std::unique(values.begin(), values.end(), equal), values.end());
+			}
+
+			auto prepare() -> void {
+				sort_unique(inserted_nodes_, std::less<>(), std::equal_to<>());
+				sort_unique(erased_nodes_, std::less<>(), std::equal_to<>());
+				sort_unique(
+				   erased_edges_,
+				   [](value_type const& lhs, value_type const& rhs) {
+					   return std::tie(lhs.from, lhs.to, lhs.weight)
+					          < std::tie(rhs.from, rhs.to, rhs.weight);
+				   },
+				   [](value_type const& lhs, value_type const& rhs) {
+					   return lhs.from == rhs.from && lhs.to == rhs.to && lhs.weight == rhs.weight;
+				   });
+			}
+
+			// Plays the transaction's effect on which nodes exist forward without touching the
+			// graph, and throws at the first change that the graph itself would reject.
+			auto validate() const -> void {
+				// Nodes that replacements have taken away from, or given to, the graph as it will be
+				// after the new nodes are added.
+				auto replaced = std::set<N>();
+				auto renamed = std::set<N>();
+				auto const exists = [&](N const& value) {
+					return renamed.contains(value)
+					       || ((graph_->is_node(value)
+					            || std::binary_search(inserted_nodes_.begin(),
+					                                  inserted_nodes_.end(),
+					                                  value))
+					           && !replaced.contains(value));
+				};
+
+				for (auto const& [old_data, new_data, merge] : replaced_nodes_) {
+					if (!exists(old_data) || (merge && !exists(new_data))) {
+						throw std::runtime_error("Cannot call gdwg::graph<N, E>::transaction::commit "
+						                         "when a replaced node doesn't exist");
+					}
+					if (old_data == new_data || (!merge && exists(new_data))) {
+						continue;
+					}
+					replaced.insert(old_data);
+					renamed.erase(old_data);
+					if (!merge) {
+						renamed.insert(new_data);
+					}
+				}
+				for (auto const& edge : erased_edges_) {
+					if (!exists(edge.from) || !exists(edge.to)) {
+						throw std::runtime_error("Cannot call gdwg::graph<N, E>::transaction::commit "
+						                         "when either src or dst of an erased edge does not "
+						                         "exist");
+					}
+				}
+				auto const survives = [&](N const& value) {
+					return exists(value)
+					       && !std::binary_search(erased_nodes_.begin(), erased_nodes_.end(), value);
+				};
+				for (auto const& edge : inserted_edges_) {
+					if (!survives(edge.from) || !survives(edge.to)) {
+						throw std::runtime_error("Cannot call gdwg::graph<N, E>::transaction::commit "
+						                         "when either src or dst of an inserted edge does not "
+						                         "exist");
+					}
+				}
+			}
+
+			auto clear() -> void {
+				inserted_nodes_.clear();
+				replaced_nodes_.clear();
+				erased_edges_.clear();
+				erased_nodes_.clear();
+				inserted_edges_.clear();
+			}
+
+			friend class graph;
+		};
+
+		// Starts a set of changes to apply together. The graph must outlive the transaction.
+		[[nodiscard]] auto batch() -> transaction {
+			return transaction(*this);
+		}
+
+		[[nodiscard]] auto get_allocator() const -> allocator_type {
+			return alloc_;
+		}
+
+		[[nodiscard]] auto in_edges_indexed() const -> bool {
+			return in_index_ == in_edge_index::enabled;
+		}
+
+		[[nodiscard]] auto lookup() const -> node_lookup {
+			return lookup_;
+		}
+
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return find_node(value) != index_.end();
 		}
 
-		[[nodiscard]] auto empty() -> bool {
-			return nodes_.empty() && edges.empty();
+		[[nodiscard]] auto empty() const -> bool {
+			return index_.empty();
 		}
 
-		[[nodiscard]] auto is_connected(N const& src, N const& dst) -> bool {
-			if (!is_node(src) || !is_node(dst)) {
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			auto srcNode = find_node(src);
+			auto dstNode = find_node(dst);
+			if (srcNode == index_.end() || dstNode == index_.end()) {
 				throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst "
 				                         "node don't exist in the graph");
 			}
-			auto search_src = find_if(edges.begin(), edges.end(), [&src, &dst](auto const& p) {
-				return *p.from == src && *p.to == dst;
-			});
-			if (search_src != edges.end()) {
-				return true;
+			if (hashed()) {
+				return find_run(srcNode->second, dstNode->second) != nullptr;
 			}
-			return false;
+			return edges_.find(endpoints_key{srcNode->second, dstNode->second}) != edges_.end();
 		}
 
-		[[nodiscard]] auto nodes() -> std::vector<N> {
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
 			std::vector<N> ret;
-			for (auto it = nodes_.begin(); it != nodes_.end(); it++) {
-				ret.push_back(*(it->value));
+			ret.reserve(index_.size());
+			for (auto const& it : index_) {
+				ret.push_back(it.first);
 			}
 			return ret;
 		}
 
-		[[nodiscard]] auto weights(N const& src, N const& dst) -> std::vector<E> {
-			if (!is_node(src) || !is_node(dst)) {
+		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
+			auto srcNode = find_node(src);
+			auto dstNode = find_node(dst);
+			if (srcNode == index_.end() || dstNode == index_.end()) {
 				throw std::runtime_error("Cannot call gdwg::graph<N, E>::weights if src or dst node "
 				                         "don't exist in the graph");
 			}
 
-			struct node findNode;
-			findNode.value = std::make_shared<N>(src);
-			auto srcNode = nodes_.find(findNode);
+			auto [first, last] = edge_range_of(srcNode->second, dstNode->second);
+			std::vector<E> ret;
+			ret.reserve(static_cast<std::size_t>(std::distance(first, last)));
+			for (auto it = first; it != last; it++) {
+				ret.push_back(it->weight);
+			}
+
+			return ret;
+		}
 
-			struct node findNode2;
-			findNode2.value = std::make_shared<N>(dst);
-			auto dstNode = nodes_.find(findNode2);
+		[[nodiscard]] auto find(N const& src, N const& dst, E const& weight) const -> iterator {
+			auto srcNode = find_node(src);
+			auto dstNode = find_node(dst);
+			if (srcNode == index_.end() || dstNode == index_.end()) {
+				return end();
+			}
+			return iterator(edges_.find(edge_key{srcNode->second, dstNode->second, weight}),
+			                nodes_.get());
+		}
 
-			std::vector<E> ret;
-			for (auto it = edges.begin(); it != edges.end(); it++) {
-				if (it->from == srcNode->value && it->to == dstNode->value) {
-					ret.push_back(it->weight);
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			auto srcNode = find_node(src);
+			if (srcNode == index_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::connections if src doesn't "
+				                         "exist in the graph");
+			}
+
+			std::vector<N> ret;
+			auto prev = srcNode->second;
+			for (auto const& it : out_run(srcNode->second)) {
+				if (ret.empty() || it.to != prev) {
+					ret.push_back(value(it.to));
 				}
+				prev = it.to;
 			}
 
 			return ret;
 		}
 
-		[[nodiscard]] auto find(N const& src, N const& dst, E const& weight) -> iterator {
-			struct edge findEdge;
-			findEdge.from = std::make_shared<N>(src);
-			findEdge.to = std::make_shared<N>(dst);
-			findEdge.weight = weight;
+		// Lazy views over part of the graph. Each one is a slice of the graph's own storage, so
+		// making and walking one allocates nothing, and each is invalidated by the same changes that
+		// would invalidate an iterator to the edges it covers.
 
-			auto it = edges.find(findEdge);
-			if (it != edges.end()) {
-				return iterator(it);
+		// The edges leaving `src`, in (dst, weight) order.
+		[[nodiscard]] auto out_edges(N const& src) const -> out_edge_range {
+			auto srcNode = find_node(src);
+			if (srcNode == index_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::out_edges if src doesn't "
+				                         "exist in the graph");
 			}
-			return iterator(edges.end());
+			auto const& n = (*nodes_)[srcNode->second];
+			return out_edge_range(std::counted_iterator(iterator(n.out_first, nodes_.get()),
+			                                            static_cast<std::ptrdiff_t>(n.out_degree)),
+			                      std::default_sentinel);
 		}
 
-		[[nodiscard]] auto connections(N const& src) -> std::vector<N> {
-			if (!is_node(src)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::connections if src doesn't "
+		// The edges ending at `dst`. They are grouped by source, but the groups are not in any
+		// particular order. Needs the in-edge index.
+		[[nodiscard]] auto in_edges(N const& dst) const {
+			auto dstNode = find_node(dst);
+			if (dstNode == index_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::in_edges if dst doesn't "
 				                         "exist in the graph");
 			}
+			if (!in_edges_indexed()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::in_edges on a graph without "
+				                         "an in-edge index");
+			}
+			return (*nodes_)[dstNode->second].in
+			       | std::views::transform(
+			          [nodes = nodes_.get()](edge_iterator it) { return *iterator(it, nodes); });
+		}
 
-			struct node findNode;
-			findNode.value = std::make_shared<N>(src);
-			auto srcNode = nodes_.find(findNode);
+		// The nodes `src` has an edge to, each once and in order: a lazy `connections`.
+		[[nodiscard]] auto neighbors(N const& src) const -> neighbor_range {
+			auto srcNode = find_node(src);
+			if (srcNode == index_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::neighbors if src doesn't "
+				                         "exist in the graph");
+			}
+			auto const& n = (*nodes_)[srcNode->second];
+			return neighbor_range(neighbor_iterator(n.out_first, n.out_degree, nodes_.get()),
+			                      std::default_sentinel);
+		}
+
+		// The edges from `src` to `dst`, in weight order: a lazy `weights`.
+		[[nodiscard]] auto edges_between(N const& src, N const& dst) const -> edge_range {
+			auto srcNode = find_node(src);
+			auto dstNode = find_node(dst);
+			if (srcNode == index_.end() || dstNode == index_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::edges_between if src or dst "
+				                         "node don't exist in the graph");
+			}
+			auto [first, last] = edge_range_of(srcNode->second, dstNode->second);
+			return edge_range(iterator(first, nodes_.get()), iterator(last, nodes_.get()));
+		}
+
+		// The nodes with an edge to `dst`, each once and in order.
+		[[nodiscard]] auto predecessors(N const& dst) const -> std::vector<N> {
+			auto dstNode = find_node(dst);
+			if (dstNode == index_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::predecessors if dst doesn't "
+				                         "exist in the graph");
+			}
 
+			// Either way the incoming edges arrive grouped by source, so each source is taken once.
 			std::vector<N> ret;
-			N prev;
-			for (auto it = edges.begin(); it != edges.end(); it++) {
-				if (it->from == srcNode->value) {
-					if (prev != *(it->to)) {
-						ret.push_back(*(it->to));
-					}
-					prev = *(it->to);
+			auto prev = std::optional<node_id>();
+			for_each_in_edge(dstNode->second, [&](edge_iterator it) {
+				if (it->from != prev) {
+					ret.push_back(value(it->from));
+					prev = it->from;
 				}
+			});
+			if (in_edges_indexed()) {
+				std::sort(ret.begin(), ret.end());
 			}
+			return ret;
+		}
 
+		// The number of edges ending at `dst`.
+		[[nodiscard]] auto in_degree(N const& dst) const -> std::size_t {
+			auto dstNode = find_node(dst);
+			if (dstNode == index_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::in_degree if dst doesn't "
+				                         "exist in the graph");
+			}
+			if (in_edges_indexed()) {
+				return (*nodes_)[dstNode->second].in.size();
+			}
+			auto ret = std::size_t{0};
+			for_each_in_edge(dstNode->second, [&ret](edge_iterator) { ++ret; });
 			return ret;
 		}
 
+		// Ids are private to each graph, so edges are compared by the values they connect.
 		[[nodiscard]] auto operator==(graph const& other) const -> bool {
-			return (nodes_ == other.nodes_ && edges == other.edges);
+			if (index_.size() != other.index_.size() || edges_.size() != other.edges_.size()) {
+				return false;
+			}
+			auto const same_nodes = std::equal(
+			   index_.begin(),
+			   index_.end(),
+			   other.index_.begin(),
+			   [](auto const& lhs, auto const& rhs) { return lhs.first == rhs.first; });
+			return same_nodes
+			       && std::equal(edges_.begin(),
+			                     edges_.end(),
+			                     other.edges_.begin(),
+			                     [this, &other](edge const& lhs, edge const& rhs) {
+				                     return value(lhs.from) == other.value(rhs.from)
+				                            && value(lhs.to) == other.value(rhs.to)
+				                            && lhs.weight == rhs.weight;
+			                     });
 		}
 
+		// Values are formatted into a buffer and written to `os` a large chunk at a time. A stream
+		// with non-default formatting (flags, width or locale) is written to one value at a time
+		// instead, so the output always matches what `os << value` would produce.
 		friend auto operator<<(std::ostream& os, graph const& g) -> std::ostream& {
-			auto nodesit = g.nodes_.begin();
-			N curr = *(nodesit->value);
-			os << curr << " (\n";
+			if (!detail::has_default_format(os)) {
+				for (auto const& [value, id] : g.index_) {
+					os << value << " (\n";
+					for (auto const& it : g.out_run(id)) {
+						os << "  " << g.value(it.to) << " | " << it.weight << "\n";
+					}
+					os << ")\n";
+				}
+				return os;
+			}
+
+			auto buffer = std::string();
+			g.write_text(buffer, os.precision(), [&os](std::string& chunk) {
+				os.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+				chunk.clear();
+			});
+			return os;
+		}
+
+		// Appends the output of `operator<<` (on a default-formatted stream) to `out`.
+		friend auto dump(graph const& g, std::string& out) -> void {
+			g.write_text(out, detail::default_precision, [](std::string&) {});
+		}
 
-			for (auto edgesit = g.edges.begin(); edgesit != g.edges.end();) {
-				if (curr != *(edgesit->from)) {
-					nodesit++;
-					curr = *(nodesit->value);
-					os << ")\n" << curr << " (\n";
+		// Passes the output of `operator<<` (on a default-formatted stream) to `sink` as a series of
+		// `std::string_view`s, a large chunk at a time, so that none of it has to go through a
+		// stream. gdwg/posix_io.hpp uses this to write to a file descriptor.
+		template<typename Sink>
+		requires std::invocable<Sink&, std::string_view>
+		friend auto dump(graph const& g, Sink sink) -> void {
+			auto buffer = std::string();
+			g.write_text(buffer, detail::default_precision, [&sink](std::string& chunk) {
+				sink(std::string_view(chunk));
+				chunk.clear();
+			});
+		}
+
+		// Reads a graph in the format `operator<<` writes, replacing the contents of `g`, to the end
+		// of the input. The input is read a block at a time, so beyond the graph itself memory use
+		// is bounded by the longest line, and edges are appended in the order they are written,
+		// which is the graph's own order. A node written as a destination before its own block is
+		// added then. Values can't contain a newline, and node values can't contain " | ". Throws
+		// `parse_error` on malformed input, leaving `g` unchanged.
+		friend auto operator>>(std::istream& is, graph& g) -> std::istream& {
+			auto read = graph(g.in_index_, g.alloc_);
+			read.lookup_ = g.lookup_;
+			read.read_text(is);
+			g = std::move(read);
+			return is;
+		}
+
+	private:
+		// Formats the graph into `buffer`, calling `flush(buffer)` whenever it holds a chunk and
+		// once at the end. `flush` decides whether to empty the buffer.
+		template<typename Flush>
+		auto write_text(std::string& buffer, std::streamsize precision, Flush flush) const -> void {
+			constexpr auto chunk_size = std::size_t{1} << 16;
+			auto formatter = detail::text_formatter(precision);
+			auto flushed_at = buffer.size();
+			for (auto const& [node_value, id] : index_) {
+				formatter.append(buffer, node_value);
+				buffer.append(" (\n");
+				for (auto const& it : out_run(id)) {
+					buffer.append("  ");
+					formatter.append(buffer, value(it.to));
+					buffer.append(" | ");
+					formatter.append(buffer, it.weight);
+					buffer.push_back('\n');
+				}
+				buffer.append(")\n");
+				if (buffer.size() - flushed_at >= chunk_size) {
+					flush(buffer);
+					flushed_at = buffer.size();
+				}
+			}
+			flush(buffer);
+		}
+
+		auto read_text(std::istream& is) -> void {
+			auto reader = detail::line_reader(is);
+			auto line_number = std::size_t{0};
+			auto src = std::optional<node_id>();
+			auto from = N();
+			auto to = N();
+			auto weight = E();
+			while (auto const line = reader.next()) {
+				++line_number;
+				if (!src) {
+					if (!line->ends_with(" (")) {
+						throw parse_error(line_number, "expected a node followed by \" (\"");
+					}
+					if (!detail::parse_value(line->substr(0, line->size() - 2), from)) {
+						throw parse_error(line_number, "cannot parse the node");
+					}
+					src = intern(from);
+				}
+				else if (*line == ")") {
+					src.reset();
 				}
 				else {
-					os << "  " << *(edgesit->to) << " | " << edgesit->weight << "\n";
-					edgesit++;
+					auto const separator = line->find(" | ", 2);
+					if (!line->starts_with("  ") || separator == std::string_view::npos) {
+						throw parse_error(line_number, "expected \"  dst | weight\" or \")\"");
+					}
+					if (!detail::parse_value(line->substr(2, separator - 2), to)) {
+						throw parse_error(line_number, "cannot parse the edge's destination");
+					}
+					if (!detail::parse_value(line->substr(separator + 3), weight)) {
+						throw parse_error(line_number, "cannot parse the edge's weight");
+					}
+					append_edge(*src, intern(to), weight);
 				}
 			}
+			if (src) {
+				throw parse_error(line_number, "expected \")\" before the end of the input");
+			}
+		}
 
-			nodesit++;
-			while (nodesit != g.nodes_.end()) {
-				os << ")\n" << *(nodesit->value) << " (\n";
-				nodesit++;
+		// The id of `value`, inserting it if needed.
+		auto intern(N const& value) -> node_id {
+			auto it = find_node(value);
+			if (it == index_.end()) {
+				insert_node(value);
+				it = find_node(value);
 			}
-			os << ")\n";
-			return os;
+			return it->second;
 		}
 
-	private:
-		std::set<node> nodes_;
-		std::set<edge> edges;
+		// Inserts a sorted batch whose endpoints have been resolved to `srcs` and `dsts`.
+		auto insert_resolved(std::vector<value_type>& batch,
+		                     std::vector<node_id> const& srcs,
+		                     std::vector<node_id> const& dsts) -> std::size_t {
+			auto sorted = std::vector<edge>();
+			sorted.reserve(batch.size());
+			for (auto i = std::size_t{0}; i < batch.size(); ++i) {
+				sorted.push_back(edge{srcs[i], dsts[i], std::move(batch[i].weight)});
+			}
+			return insert_sorted(std::make_move_iterator(sorted.begin()),
+			                     std::make_move_iterator(sorted.end()));
+		}
+
+		// Inserts edges that are already in `edges_` order, each with the hint left by the one
+		// before it, and returns how many of them were new.
+		template<typename InputIt>
+		auto insert_sorted(InputIt first, InputIt last) -> std::size_t {
+			auto inserted = std::size_t{0};
+			auto hint = edges_.begin();
+			for (; first != last; ++first) {
+				auto const size = edges_.size();
+				auto it = edges_.insert(hint, *first);
+				if (edges_.size() != size) {
+					link(it);
+					++inserted;
+				}
+				hint = std::next(it);
+			}
+			return inserted;
+		}
+
+		// Inserts an edge with a hint at the end of the edge set, which is where it goes when edges
+		// arrive in order.
+		auto append_edge(node_id src, node_id dst, E const& weight) -> void {
+			auto const size = edges_.size();
+			auto it = edges_.insert(edges_.end(), edge{src, dst, weight});
+			if (edges_.size() != size) {
+				link(it);
+			}
+		}
+
+		// The edges from one node to another are contiguous in `edges_`, so they are found by their
+		// first edge and how many there are.
+		struct edge_run {
+			std::uint64_t endpoints = 0;
+			edge_iterator first;
+			std::size_t count = 0;
+		};
+
+		[[nodiscard]] auto hashed() const -> bool {
+			if constexpr (detail::hashable<N>) {
+				return lookup_ == node_lookup::hashed;
+			}
+			else {
+				return false;
+			}
+		}
+
+		static auto node_hash(N const& value) -> std::size_t {
+			if constexpr (detail::hashable<N>) {
+				return detail::mix_hash(std::hash<N>{}(value));
+			}
+			else {
+				return 0;
+			}
+		}
+
+		static auto endpoints(node_id src, node_id dst) -> std::uint64_t {
+			return std::uint64_t{src} << 32 | dst;
+		}
+
+		// `index_.find`, through the hash table when there is one.
+		auto find_node(N const& value) const -> typename node_index::const_iterator {
+			if (auto const* found = find_hashed(value)) {
+				return *found;
+			}
+			return hashed() ? index_.end() : index_.find(value);
+		}
+
+		auto find_node(N const& value) -> typename node_index::iterator {
+			if (auto const* found = find_hashed(value)) {
+				return *found;
+			}
+			return hashed() ? index_.end() : index_.find(value);
+		}
+
+		auto find_hashed(N const& value) const -> typename node_index::iterator const* {
+			if constexpr (detail::hashable<N>) {
+				if (hashed()) {
+					return hashed_nodes_.find(node_hash(value),
+					                          [&value](auto it) { return it->first == value; });
+				}
+			}
+			return nullptr;
+		}
+
+		// Removes a node that is about to leave `index_` from the hash table.
+		auto forget_node(typename node_index::iterator it) -> void {
+			if (hashed()) {
+				hashed_nodes_.erase(node_hash(it->first), [it](auto entry) { return entry == it; });
+			}
+		}
+
+		// The edges from `src` to `dst`.
+		auto edge_range_of(node_id src, node_id dst) const
+		   -> std::pair<edge_iterator, edge_iterator> {
+			if (!hashed()) {
+				return edges_.equal_range(endpoints_key{src, dst});
+			}
+			auto const* run = find_run(src, dst);
+			if (run == nullptr) {
+				return {edges_.end(), edges_.end()};
+			}
+			return {run->first, std::next(run->first, static_cast<std::ptrdiff_t>(run->count))};
+		}
+
+		// The run of edges from `src` to `dst`, or null if there are none. Needs `hashed()`.
+		auto find_run(node_id src, node_id dst) const -> edge_run const* {
+			auto const key = endpoints(src, dst);
+			return hashed_edges_.find(detail::mix_hash(key),
+			                          [key](edge_run const& run) { return run.endpoints == key; });
+		}
+
+		auto add_to_run(edge_iterator it) -> void {
+			auto const key = endpoints(it->from, it->to);
+			auto const hash = detail::mix_hash(key);
+			auto* run =
+			   hashed_edges_.find(hash, [key](edge_run const& r) { return r.endpoints == key; });
+			if (run == nullptr) {
+				hashed_edges_.insert(hash, edge_run{key, it, 1});
+				return;
+			}
+			if (std::next(it) == run->first) {
+				run->first = it;
+			}
+			++run->count;
+		}
+
+		auto remove_from_run(edge_iterator it) -> void {
+			auto const key = endpoints(it->from, it->to);
+			auto const hash = detail::mix_hash(key);
+			auto const match = [key](edge_run const& r) { return r.endpoints == key; };
+			// Every edge is counted in its pair's run, so the run is always there.
+			auto* run = hashed_edges_.find(hash, match);
+			assert(run != nullptr);
+			if (--run->count == 0) {
+				hashed_edges_.erase(hash, match);
+			}
+			else if (run->first == it) {
+				run->first = std::next(it);
+			}
+		}
+
+		static auto make_table(Allocator const& alloc) -> table_ptr {
+			auto table_alloc = allocator_for<node_table>(alloc);
+			using table_traits = std::allocator_traits<allocator_for<node_table>>;
+			auto* table = table_traits::allocate(table_alloc, 1);
+			try {
+				std::construct_at(table, allocator_for<node>(alloc));
+			} catch (...) {
+				table_traits::deallocate(table_alloc, table, 1);
+				throw;
+			}
+			return table_ptr(table, table_deleter{table_alloc});
+		}
+
+		auto value(node_id id) const -> N const& {
+			return *(*nodes_)[id].value;
+		}
+
+		auto out_run(node_id id) const -> out_range {
+			auto const& n = (*nodes_)[id];
+			return out_range(std::counted_iterator(n.out_first,
+			                                       static_cast<std::ptrdiff_t>(n.out_degree)),
+			                 std::default_sentinel);
+		}
+
+		auto insert_edge(node_id src, node_id dst, E const& weight) -> bool {
+			auto hint = edges_.lower_bound(edge_key{src, dst, weight});
+			if (hint != edges_.end() && hint->from == src && hint->to == dst
+			    && hint->weight == weight) {
+				return false;
+			}
+
+			link(edges_.insert(hint, edge{src, dst, weight}));
+			return true;
+		}
+
+		using in_handle = typename decltype(node::in)::node_type;
+
+		// Records a newly inserted edge in its source's run and its target's incoming list, reusing
+		// the list entry `in` if one is given.
+		auto link(edge_iterator it, in_handle in = {}) -> void {
+			auto& src = (*nodes_)[it->from];
+			if (it == edges_.begin() || std::prev(it)->from != it->from) {
+				src.out_first = it;
+			}
+			++src.out_degree;
+			if (hashed()) {
+				add_to_run(it);
+			}
+			if (!in_edges_indexed()) {
+				return;
+			}
+			if (in) {
+				in.value() = it;
+				(*nodes_)[it->to].in.insert(std::move(in));
+			}
+			else {
+				(*nodes_)[it->to].in.insert(it);
+			}
+		}
+
+		auto erase_edge_at(edge_iterator it) -> edge_iterator {
+			unlink(it);
+			if (in_edges_indexed()) {
+				(*nodes_)[it->to].in.erase(it);
+			}
+			return edges_.erase(it);
+		}
+
+		// Takes an edge out of its source's run, leaving its target's incoming list to the caller.
+		auto unlink(edge_iterator it) -> void {
+			auto& src = (*nodes_)[it->from];
+			if (src.out_first == it) {
+				src.out_first = std::next(it);
+			}
+			--src.out_degree;
+			if (hashed()) {
+				remove_from_run(it);
+			}
+		}
+
+		// An edge taken out of the graph along with its entry in its target's incoming list (empty
+		// without the in-edge index), so it can be put back without allocating.
+		struct detached_edge {
+			typename edge_set::node_type edge;
+			in_handle in;
+		};
+
+		// Takes every edge into or out of `id` out of the graph.
+		auto detach_incident_edges(node_id id) -> std::vector<detached_edge> {
+			auto const& n = (*nodes_)[id];
+			auto ret = std::vector<detached_edge>();
+			auto const detach = [this, &ret](edge_iterator it) {
+				unlink(it);
+				auto in = in_edges_indexed() ? (*nodes_)[it->to].in.extract(it) : in_handle();
+				ret.push_back(detached_edge{edges_.extract(it), std::move(in)});
+			};
+
+			if (in_edges_indexed()) {
+				ret.reserve(n.in.size() + n.out_degree);
+				while (!n.in.empty()) {
+					detach(*n.in.begin());
+				}
+			}
+			else {
+				for (auto it = edges_.begin(); it != edges_.end();) {
+					auto const next = std::next(it);
+					if (it->to == id) {
+						detach(it);
+					}
+					it = next;
+				}
+			}
+			while (n.out_degree > 0) {
+				detach(n.out_first);
+			}
+			return ret;
+		}
+
+		// Puts back edges taken out by `detach_incident_edges`, with `old_id` replaced by `new_id`
+		// at either end. An edge that now duplicates one already in the graph is dropped.
+		auto reattach_edges(std::vector<detached_edge>& edges, node_id old_id, node_id new_id)
+		   -> void {
+			for (auto& detached : edges) {
+				auto& e = detached.edge.value();
+				e.from = e.from == old_id ? new_id : e.from;
+				e.to = e.to == old_id ? new_id : e.to;
+				auto const result = edges_.insert(std::move(detached.edge));
+				if (result.inserted) {
+					link(result.position, std::move(detached.in));
+				}
+			}
+		}
+
+		// Calls `f` with every edge ending at `id`: straight from its incoming list if the graph
+		// keeps one, otherwise by scanning every edge.
+		template<typename F>
+		auto for_each_in_edge(node_id id, F f) const -> void {
+			if (in_edges_indexed()) {
+				for (auto it : (*nodes_)[id].in) {
+					f(it);
+				}
+				return;
+			}
+			for (auto it = edges_.begin(); it != edges_.end(); ++it) {
+				if (it->to == id) {
+					f(it);
+				}
+			}
+		}
+
+		// Removes every edge into or out of `id` in O(degree * log) by walking its own incoming list
+		// and its run of outgoing edges, rather than the whole edge set. Without the in-edge index
+		// the incoming half is a scan.
+		auto erase_incident_edges(node_id id) -> void {
+			auto const& n = (*nodes_)[id];
+			if (in_edges_indexed()) {
+				while (!n.in.empty()) {
+					erase_edge_at(*n.in.begin());
+				}
+			}
+			else {
+				for (auto it = edges_.begin(); it != edges_.end();) {
+					it = it->to == id ? erase_edge_at(it) : std::next(it);
+				}
+			}
+			while (n.out_degree > 0) {
+				erase_edge_at(n.out_first);
+			}
+		}
+
+		// Erases every node in `values` that exists. With the in-edge index each node's edges are
+		// found through its own lists; without it, one sweep over the edge set removes the edges of
+		// all of them, rather than one sweep per node.
+		auto erase_nodes(std::vector<N> const& values) -> void {
+			auto doomed = std::vector<typename node_index::iterator>();
+			for (auto const& value : values) {
+				auto it = find_node(value);
+				if (it != index_.end()) {
+					doomed.push_back(it);
+				}
+			}
+			if (doomed.empty()) {
+				return;
+			}
+
+			if (in_edges_indexed()) {
+				for (auto it : doomed) {
+					erase_incident_edges(it->second);
+				}
+			}
+			else {
+				auto marked = std::vector<bool>(nodes_->size());
+				for (auto it : doomed) {
+					marked[it->second] = true;
+				}
+				for (auto it = edges_.begin(); it != edges_.end();) {
+					it = marked[it->from] || marked[it->to] ? erase_edge_at(it) : std::next(it);
+				}
+			}
+			for (auto it : doomed) {
+				erase_node_at(it);
+			}
+		}
+
+		// Releases a node that no longer has any edges, making its id available for reuse.
+		auto erase_node_at(typename node_index::iterator it) -> void {
+			auto const id = it->second;
+			(*nodes_)[id].value = nullptr;
+			free_ids_.push_back(id);
+			forget_node(it);
+			index_.erase(it);
+		}
+
+		[[no_unique_address]] Allocator alloc_;
+		// Nodes in value order, each mapped to its id. This owns every N in the graph.
+		node_index index_{typename node_index::allocator_type(alloc_)};
+		// The node table, indexed by id. It lives on the heap so that `edge_less`, which reads
+		// node values out of it, stays valid when the graph is moved.
+		table_ptr nodes_ = make_table(alloc_);
+		std::vector<node_id, allocator_for<node_id>> free_ids_{allocator_for<node_id>(alloc_)};
+		edge_set edges_{edge_less{nodes_.get()}, allocator_for<edge>(alloc_)};
+		in_edge_index in_index_ = in_edge_index::enabled;
+		node_lookup lookup_ = node_lookup::ordered;
+		// With `node_lookup::hashed`, every node's entry in `index_`, and the run of edges between
+		// every pair of nodes with at least one edge; otherwise empty.
+		detail::flat_table<typename node_index::iterator, Allocator> hashed_nodes_{alloc_};
+		detail::flat_table<edge_run, Allocator> hashed_edges_{alloc_};
+
+		friend struct detail::graph_access;
+		friend struct detail::graph_builder;
 	};
+
+	namespace detail {
+		// Gives the algorithms in gdwg/algorithm.hpp read access to a graph by node id, so they can
+		// keep their per-node state in flat arrays and walk adjacency without going through N.
+		struct graph_access {
+			// One past the largest id in use; ids of erased nodes below it are simply unused.
+			template<typename N, typename E, typename A>
+			static auto id_bound(graph<N, E, A> const& g) -> std::size_t {
+				return g.nodes_ ? g.nodes_->size() : 0;
+			}
+
+			template<typename N, typename E, typename A>
+			static auto find_id(graph<N, E, A> const& g, N const& value)
+			   -> std::optional<typename graph<N, E, A>::node_id> {
+				auto it = g.find_node(value);
+				if (it == g.index_.end()) {
+					return std::nullopt;
+				}
+				return it->second;
+			}
+
+			template<typename N, typename E, typename A>
+			static auto value(graph<N, E, A> const& g, typename graph<N, E, A>::node_id id)
+			   -> N const& {
+				return g.value(id);
+			}
+
+			// The edges leaving `id`, as objects with `to` (an id) and `weight` members.
+			template<typename N, typename E, typename A>
+			static auto out_edges(graph<N, E, A> const& g, typename graph<N, E, A>::node_id id) {
+				return g.out_run(id);
+			}
+
+			template<typename N, typename E, typename A>
+			static auto out_degree(graph<N, E, A> const& g, typename graph<N, E, A>::node_id id)
+			   -> std::size_t {
+				return (*g.nodes_)[id].out_degree;
+			}
+
+			// The source id of every edge entering `id`, in increasing order.
+			template<typename N, typename E, typename A>
+			static auto in_sources(graph<N, E, A> const& g, typename graph<N, E, A>::node_id id) {
+				return (*g.nodes_)[id].in | std::views::transform([](auto it) { return it->from; });
+			}
+
+			template<typename N, typename E, typename A>
+			static auto has_in_edges(graph<N, E, A> const& g) -> bool {
+				return g.in_edges_indexed();
+			}
+
+			template<typename N, typename E, typename A>
+			static auto edge_count(graph<N, E, A> const& g) -> std::size_t {
+				return g.edges_.size();
+			}
+
+			// Every (value, id) pair in the graph, in value order.
+			template<typename N, typename E, typename A>
+			static auto index(graph<N, E, A> const& g) -> auto const& {
+				return g.index_;
+			}
+		};
+	} // namespace detail
+
+	// Reads a graph written by `operator<<`; see `operator>>`.
+	template<typename N, typename E, typename Allocator = std::allocator<N>>
+	auto read_graph(std::istream& is, Allocator const& alloc = Allocator())
+	   -> graph<N, E, Allocator> {
+		auto g = graph<N, E, Allocator>(alloc);
+		is >> g;
+		return g;
+	}
+
+	namespace pmr {
+		template<typename N, typename E>
+		using graph = gdwg::graph<N, E, std::pmr::polymorphic_allocator<N>>;
+	} // namespace pmr
 } // namespace gdwg
 
 #endif // GDWG_GRAPH_HPP
@@ -0,0 +1,142 @@
+#ifndef GDWG_PARALLEL_BUILD_HPP
+#define GDWG_PARALLEL_BUILD_HPP
+
+#include "gdwg/graph.hpp"
+#include "gdwg/workers.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace gdwg {
+	struct build_options {
+		// Worker threads to sort the batch with. Zero means one per hardware thread, scaled down
+		// for small batches where starting threads would cost more than the sort.
+		unsigned threads = 0;
+	};
+
+	namespace detail {
+		// Builds a batch of edges into a graph in three steps:
+		//
+		// 1. Each worker resolves the endpoints of its slice of the batch to ids, and deals the
+		//    edges out into one bucket per partition. Partitions cover contiguous ranges of source
+		//    nodes (in value order), so every edge from a node goes to the same one.
+		// 2. Each worker gathers one partition from every worker's buckets, then sorts and
+		//    deduplicates it. Sorting compares each node's rank in value order rather than N, so
+		//    it's the same order as `edges_` at the cost of an integer compare.
+		// 3. The partitions, which are already in order relative to each other, are appended to
+		//    the graph one after another.
+		//
+		// Only the last step writes to the graph, and it runs on the calling thread, so no edge is
+		// ever locked. The first two only read it, which is safe for any number of threads.
+		struct graph_builder {
+			template<typename N, typename E, typename A, typename InputIt>
+			static auto insert_edges(graph<N, E, A>& g,
+			                         InputIt first,
+			                         InputIt last,
+			                         build_options const& options) -> std::size_t {
+				using edge = typename graph<N, E, A>::edge;
+				using node_id = typename graph<N, E, A>::node_id;
+
+				auto batch = std::vector<typename graph<N, E, A>::value_type>(first, last);
+				constexpr auto edges_per_thread = std::size_t{16384};
+				auto const threads = options.threads == 0
+				                        ? default_threads(batch.size(), edges_per_thread)
+				                        : options.threads;
+				if (threads <= 1 || batch.empty()) {
+					return g.insert_edges(std::make_move_iterator(batch.begin()),
+					                      std::make_move_iterator(batch.end()));
+				}
+
+				auto rank = std::vector<std::uint32_t>(graph_access::id_bound(g));
+				auto next_rank = std::uint32_t{0};
+				for (auto const& [value, id] : graph_access::index(g)) {
+					rank[id] = next_rank++;
+				}
+				auto const partition_of = [&rank, next_rank, threads](node_id id) {
+					return static_cast<std::size_t>(std::uint64_t{rank[id]} * threads / next_rank);
+				};
+
+				// buckets[t][p] holds the edges that worker t found for partition p.
+				auto buckets = std::vector<std::vector<std::vector<edge>>>(
+				   threads,
+				   std::vector<std::vector<edge>>(threads));
+				auto missing = std::atomic<bool>(false);
+				run_workers(threads, [&](unsigned t) {
+					auto const begin = batch.size() * t / threads;
+					auto const end = batch.size() * (t + 1) / threads;
+					auto& mine = buckets[t];
+					for (auto i = begin; i < end && !missing.load(std::memory_order_relaxed); ++i) {
+						auto const src = graph_access::find_id(g, batch[i].from);
+						auto const dst = graph_access::find_id(g, batch[i].to);
+						if (!src || !dst) {
+							missing.store(true, std::memory_order_relaxed);
+							return;
+						}
+						mine[partition_of(*src)].push_back(edge{*src, *dst, std::move(batch[i].weight)});
+					}
+				});
+				if (missing.load(std::memory_order_relaxed)) {
+					throw std::runtime_error("Cannot call gdwg::insert_edges when either src or dst "
+					                         "node does not exist");
+				}
+
+				auto partitions = std::vector<std::vector<edge>>(threads);
+				run_workers(threads, [&](unsigned p) {
+					auto& part = partitions[p];
+					auto size = std::size_t{0};
+					for (auto const& bucket : buckets) {
+						size += bucket[p].size();
+					}
+					part.reserve(size);
+					for (auto& bucket : buckets) {
+						std::move(bucket[p].begin(), bucket[p].end(), std::back_inserter(part));
+						bucket[p] = std::vector<edge>();
+					}
+
+					std::sort(part.begin(), part.end(), [&rank](edge const& lhs, edge const& rhs) {
+						if (lhs.from != rhs.from) {
+							return rank[lhs.from] < rank[rhs.from];
+						}
+						if (lhs.to != rhs.to) {
+							return rank[lhs.to] < rank[rhs.to];
+						}
+						return lhs.weight < rhs.weight;
+					});
+					part.erase(std::unique(part.begin(),
+					                       part.end(),
+					                       [](edge const& lhs, edge const& rhs) {
+						                       return lhs.from == rhs.from && lhs.to == rhs.to
+						                              && lhs.weight == rhs.weight;
+					                       }),
+					           part.end());
+				});
+
+				auto inserted = std::size_t{0};
+				for (auto& part : partitions) {
+					inserted += g.insert_sorted(std::make_move_iterator(part.begin()),
+					                            std::make_move_iterator(part.end()));
+				}
+				return inserted;
+			}
+		};
+	} // namespace detail
+
+	// Inserts a batch of edges into `g` and returns how many of them were new, like
+	// `graph::insert_edges`, but sorts the batch on `options.threads` threads. If any endpoint is
+	// missing, nothing is inserted.
+	template<typename N, typename E, typename A, typename InputIt>
+	auto insert_edges(graph<N, E, A>& g,
+	                  InputIt first,
+	                  InputIt last,
+	                  build_options const& options = {}) -> std::size_t {
+		return detail::graph_builder::insert_edges(g, first, last, options);
+	}
+} // namespace gdwg
+
+#endif // GDWG_PARALLEL_BUILD_HPP
@@ -0,0 +1,40 @@
+#ifndef GDWG_POSIX_IO_HPP
+#define GDWG_POSIX_IO_HPP
+
+#include "gdwg/graph.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+
+#include <unistd.h>
+
+// Graph output straight to POSIX file descriptors. This is kept apart from gdwg/graph.hpp so that
+// the graph itself only needs the standard library.
+namespace gdwg {
+	// Writes the output of `operator<<` (on a default-formatted stream) to the file descriptor
+	// `fd`, a large chunk at a time. Throws `std::system_error` if a write fails.
+	template<typename N, typename E, typename A>
+	auto dump(graph<N, E, A> const& g, int fd) -> void {
+		dump(g, [fd](std::string_view chunk) {
+			auto const* data = chunk.data();
+			auto left = chunk.size();
+			while (left > 0) {
+				auto const written = ::write(fd, data, left);
+				if (written < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					throw std::system_error(errno,
+					                        std::generic_category(),
+					                        "Cannot call gdwg::dump on a file descriptor");
+				}
+				data += written;
+				left -= static_cast<std::size_t>(written);
+			}
+		});
+	}
+} // namespace gdwg
+
+#endif // GDWG_POSIX_IO_HPP
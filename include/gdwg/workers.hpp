@@ -0,0 +1,75 @@
+#ifndef GDWG_WORKERS_HPP
+#define GDWG_WORKERS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// The threading shared by the parallel algorithms and the parallel graph builder.
+namespace gdwg::detail {
+	// How many threads to use when the caller leaves it to the library: one per hardware thread,
+	// but no more than one per `per_thread` work items, since below that starting a thread costs
+	// more than the share of the work it would take.
+	inline auto default_threads(std::size_t work_items, std::size_t per_thread) -> unsigned {
+		auto const limit = 1 + work_items / per_thread;
+		return static_cast<unsigned>(
+		   std::min<std::size_t>(std::max(1U, std::thread::hardware_concurrency()), limit));
+	}
+
+	// Runs `f(0)` to `f(threads - 1)` concurrently, `f(0)` on the calling thread, and waits for
+	// all of them. A worker whose thread can't be started is passed to `unstarted(t)` straight
+	// away, before `f(0)` runs, so workers that meet at a barrier can drop it from the barrier and
+	// carry on without it. The first exception thrown by any worker is rethrown once they have all
+	// finished; workers that meet at a barrier must not throw, or the others wait for them forever.
+	template<typename F, typename Unstarted>
+	auto run_workers(unsigned threads, F const& f, Unstarted const& unstarted) -> void {
+		auto errors = std::vector<std::exception_ptr>(threads);
+		auto guarded = [&f, &errors](unsigned t) {
+			try {
+				f(t);
+			} catch (...) {
+				errors[t] = std::current_exception();
+			}
+		};
+
+		{
+			auto workers = std::vector<std::jthread>();
+			workers.reserve(threads - 1);
+			for (auto t = 1U; t < threads; ++t) {
+				try {
+					workers.emplace_back(guarded, t);
+				} catch (std::system_error const&) {
+					unstarted(t);
+				}
+			}
+			guarded(0);
+		}
+		for (auto const& error : errors) {
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+	}
+
+	// As above, for work split up front into `threads` shares: a worker whose thread can't be
+	// started is run on the calling thread after `f(0)`.
+	template<typename F>
+	auto run_workers(unsigned threads, F const& f) -> void {
+		auto left_over = std::vector<unsigned>();
+		left_over.reserve(threads);
+		auto const share = [&f, &left_over](unsigned t) {
+			f(t);
+			if (t == 0) {
+				for (auto u : left_over) {
+					f(u);
+				}
+			}
+		};
+		run_workers(threads, share, [&left_over](unsigned t) { left_over.push_back(t); });
+	}
+} // namespace gdwg::detail
+
+#endif // GDWG_WORKERS_HPP
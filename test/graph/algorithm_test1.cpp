@@ -0,0 +1,441 @@
+#include "gdwg/algorithm.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+	auto make_graph() -> gdwg::graph<std::string, int> {
+		auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e"};
+		g.insert_edge("a", "b", 4);
+		g.insert_edge("a", "c", 1);
+		g.insert_edge("c", "b", 2);
+		g.insert_edge("b", "d", 1);
+		g.insert_edge("c", "d", 7);
+		g.insert_edge("d", "a", 3);
+		return g;
+	}
+} // namespace
+
+TEST_CASE("Shortest paths from a source") {
+	auto const g = make_graph();
+	auto const dists = gdwg::shortest_paths(g, std::string("a"));
+	auto const expected =
+	   std::vector<std::pair<std::string, int>>{{"a", 0}, {"b", 3}, {"c", 1}, {"d", 4}};
+	CHECK(dists == expected);
+
+	CHECK_THROWS_WITH(gdwg::shortest_paths(g, std::string("z")),
+	                  "Cannot call gdwg::shortest_paths if src doesn't exist in the graph");
+}
+
+TEST_CASE("Shortest path between two nodes") {
+	auto const g = make_graph();
+
+	auto const p = gdwg::shortest_path(g, std::string("a"), std::string("d"));
+	REQUIRE(p.has_value());
+	CHECK(p->distance == 4);
+	CHECK(p->nodes == std::vector<std::string>{"a", "c", "b", "d"});
+
+	auto const self = gdwg::shortest_path(g, std::string("b"), std::string("b"));
+	REQUIRE(self.has_value());
+	CHECK(self->distance == 0);
+	CHECK(self->nodes == std::vector<std::string>{"b"});
+
+	CHECK_FALSE(gdwg::shortest_path(g, std::string("a"), std::string("e")).has_value());
+	CHECK_THROWS_WITH(gdwg::shortest_path(g, std::string("a"), std::string("z")),
+	                  "Cannot call gdwg::shortest_path if src or dst node don't exist in the graph");
+}
+
+TEST_CASE("A workspace can be reused across queries and graphs") {
+	auto g = make_graph();
+	auto workspace = gdwg::path_workspace<int>();
+
+	CHECK(gdwg::shortest_path(g, std::string("a"), std::string("d"), workspace)->distance == 4);
+	CHECK(gdwg::shortest_path(g, std::string("d"), std::string("b"), workspace)->distance == 6);
+	CHECK_FALSE(gdwg::shortest_path(g, std::string("e"), std::string("a"), workspace).has_value());
+
+	g.erase_node("c");
+	g.insert_node("f");
+	g.insert_edge("a", "f", 1);
+	auto const dists = gdwg::shortest_paths(g, std::string("a"), workspace);
+	auto const expected =
+	   std::vector<std::pair<std::string, int>>{{"a", 0}, {"b", 4}, {"d", 5}, {"f", 1}};
+	CHECK(dists == expected);
+
+	auto bigger = gdwg::graph<std::string, int>{"x", "y", "z", "w", "v", "u", "t"};
+	bigger.insert_edge("x", "t", 10);
+	bigger.insert_edge("x", "y", 1);
+	bigger.insert_edge("y", "t", 2);
+	CHECK(gdwg::shortest_path(bigger, std::string("x"), std::string("t"), workspace)->distance == 3);
+}
+
+TEST_CASE("Negative weights are rejected") {
+	auto g = gdwg::graph<int, double>{1, 2, 3};
+	g.insert_edge(1, 2, 0.5);
+	g.insert_edge(2, 3, -1.0);
+	CHECK_THROWS_WITH(gdwg::shortest_paths(g, 1),
+	                  "Cannot call gdwg::shortest_paths on a graph with negative edge weights");
+}
+
+namespace {
+	// A skewed random graph: low-numbered nodes collect most of the edges, so searches from them
+	// grow fast enough to go bottom-up.
+	auto make_skewed_graph(int n, int edges) -> gdwg::graph<int, int> {
+		auto g = gdwg::graph<int, int>();
+		for (auto i = 0; i < n; ++i) {
+			g.insert_node(i);
+		}
+		auto state = std::uint64_t{42};
+		auto next = [&state] {
+			state = state * 6364136223846793005U + 1442695040888963407U;
+			return static_cast<int>(state >> 33);
+		};
+		for (auto i = 0; i < edges; ++i) {
+			auto const src = next() % n;
+			auto const dst = next() % (1 + next() % n);
+			g.insert_edge(src, dst, i);
+		}
+		return g;
+	}
+
+	auto expected_hops(gdwg::graph<int, int>& g, int src, std::size_t max_hops)
+	   -> std::vector<std::pair<int, std::size_t>> {
+		auto hops = std::map<int, std::size_t>{{src, 0}};
+		auto frontier = std::vector<int>{src};
+		for (auto level = std::size_t{1}; level <= max_hops && !frontier.empty(); ++level) {
+			auto next = std::vector<int>();
+			for (auto from : frontier) {
+				for (auto to : g.connections(from)) {
+					if (hops.emplace(to, level).second) {
+						next.push_back(to);
+					}
+				}
+			}
+			frontier = std::move(next);
+		}
+		return {hops.begin(), hops.end()};
+	}
+} // namespace
+
+TEST_CASE("Hop distances within a limit") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("b", "c", 1);
+	g.insert_edge("c", "d", 1);
+	g.insert_edge("d", "a", 1);
+	g.insert_edge("a", "a", 1);
+
+	using hops = std::vector<std::pair<std::string, std::size_t>>;
+	CHECK(gdwg::hop_distances(g, std::string("a")) == hops{{"a", 0}, {"b", 1}, {"c", 2}, {"d", 3}});
+	CHECK(gdwg::hop_distances(g, std::string("c"), {.max_hops = 1}) == hops{{"c", 0}, {"d", 1}});
+	CHECK(gdwg::hop_distances(g, std::string("e")) == hops{{"e", 0}});
+	CHECK(gdwg::reachable(g, std::string("b"), {.max_hops = 2})
+	      == std::vector<std::string>{"b", "c", "d"});
+	CHECK(gdwg::reachable(g, std::string("b"), {.max_hops = 0}) == std::vector<std::string>{"b"});
+
+	CHECK_THROWS_WITH(gdwg::hop_distances(g, std::string("z")),
+	                  "Cannot call gdwg::hop_distances if src doesn't exist in the graph");
+	CHECK_THROWS_WITH(gdwg::reachable(g, std::string("z")),
+	                  "Cannot call gdwg::reachable if src doesn't exist in the graph");
+}
+
+TEST_CASE("Parallel searches match a sequential search") {
+	auto g = make_skewed_graph(3000, 40000);
+	for (auto i = 2500; i < 2600; ++i) {
+		g.erase_node(i);
+	}
+
+	for (auto src : {0, 7, 1234, 2999}) {
+		for (auto max_hops : {std::size_t{2}, std::numeric_limits<std::size_t>::max()}) {
+			auto const expected = expected_hops(g, src, max_hops);
+			for (auto threads : {1U, 2U, 4U, 7U}) {
+				CHECK(gdwg::hop_distances(g, src, {.max_hops = max_hops, .threads = threads})
+				      == expected);
+			}
+		}
+	}
+}
+
+TEST_CASE("Searches stay top-down without an in-edge index") {
+	auto const indexed = make_skewed_graph(3000, 40000);
+	auto g = gdwg::graph<int, int>(gdwg::in_edge_index::disabled);
+	for (auto const node : indexed.nodes()) {
+		g.insert_node(node);
+	}
+	g.insert_edges(indexed.begin(), indexed.end());
+
+	auto const options = gdwg::bfs_options{.threads = 3};
+	CHECK(gdwg::hop_distances(g, 0, options) == gdwg::hop_distances(indexed, 0, options));
+}
+
+namespace {
+	// Power iteration straight from the definition, one edge at a time through the public API.
+	template<typename N, typename E>
+	auto expected_ranks(gdwg::graph<N, E> const& g, bool weighted)
+	   -> std::vector<std::pair<N, double>> {
+		auto const nodes = g.nodes();
+		auto const n = static_cast<double>(nodes.size());
+		auto weight_of = [weighted](E const& weight) {
+			if constexpr (std::is_arithmetic_v<E>) {
+				if (weighted) {
+					return static_cast<double>(weight);
+				}
+			}
+			return 1.0;
+		};
+		auto out = std::map<N, double>();
+		for (auto const& [from, to, weight] : g) {
+			out[from] += weight_of(weight);
+		}
+
+		auto rank = std::map<N, double>();
+		for (auto const& node : nodes) {
+			rank[node] = 1 / n;
+		}
+		for (auto iteration = 0; iteration < 200; ++iteration) {
+			auto dangling = 0.0;
+			for (auto const& node : nodes) {
+				if (out[node] == 0) {
+					dangling += rank[node];
+				}
+			}
+			auto next = std::map<N, double>();
+			for (auto const& node : nodes) {
+				next[node] = (0.15 + 0.85 * dangling) / n;
+			}
+			for (auto const& [from, to, weight] : g) {
+				next[to] += 0.85 * rank[from] * weight_of(weight) / out[from];
+			}
+			rank = std::move(next);
+		}
+		return {rank.begin(), rank.end()};
+	}
+
+	template<typename N>
+	auto check_ranks(std::vector<std::pair<N, double>> const& ranks,
+	                 std::vector<std::pair<N, double>> const& expected) -> void {
+		REQUIRE(ranks.size() == expected.size());
+		auto total = 0.0;
+		for (auto i = std::size_t{0}; i < ranks.size(); ++i) {
+			CHECK(ranks[i].first == expected[i].first);
+			CHECK(ranks[i].second == Approx(expected[i].second).epsilon(1e-6));
+			total += ranks[i].second;
+		}
+		CHECK(total == Approx(1.0));
+	}
+
+	// Sums the weights of each node's in-edges.
+	struct in_weight_program {
+		auto start(std::span<double const>) -> void {
+			++starts;
+		}
+		auto gather(std::size_t, double, double weight) const -> double {
+			return weight;
+		}
+		auto apply(std::size_t, double sum) const -> double {
+			return sum;
+		}
+
+		int starts = 0;
+	};
+} // namespace
+
+TEST_CASE("PageRank follows edges in proportion to their weights") {
+	auto g = gdwg::graph<std::string, double>{"a", "b", "c", "d"};
+	g.insert_edge("a", "b", 1.0);
+	g.insert_edge("a", "c", 3.0);
+	g.insert_edge("b", "c", 1.0);
+	g.insert_edge("c", "a", 2.0);
+	g.insert_edge("c", "a", 0.5);
+	// "d" has no out-edges, so its rank is spread over every node.
+	g.insert_edge("b", "d", 1.0);
+
+	auto const ranks = gdwg::page_rank(g);
+	check_ranks(ranks, expected_ranks(g, true));
+	CHECK(ranks[2].second > ranks[1].second);
+
+	auto unweighted = gdwg::graph<std::string, std::string>{"a", "b", "c", "d"};
+	for (auto const& [from, to, weight] : g) {
+		unweighted.insert_edge(from, to, std::to_string(weight));
+	}
+	check_ranks(gdwg::page_rank(unweighted), expected_ranks(unweighted, false));
+}
+
+TEST_CASE("Parallel PageRank matches a sequential run") {
+	auto g = make_skewed_graph(3000, 40000);
+	for (auto i = 2500; i < 2600; ++i) {
+		g.erase_node(i);
+	}
+
+	auto const expected = gdwg::page_rank(g, {.threads = 1});
+	check_ranks(expected, expected_ranks(g, true));
+	for (auto threads : {2U, 4U, 7U}) {
+		auto const ranks = gdwg::page_rank(g, {.threads = threads});
+		REQUIRE(ranks.size() == expected.size());
+		for (auto i = std::size_t{0}; i < ranks.size(); ++i) {
+			CHECK(ranks[i].second == Approx(expected[i].second).epsilon(1e-9));
+		}
+	}
+}
+
+TEST_CASE("PageRank edge cases") {
+	CHECK(gdwg::page_rank(gdwg::graph<int, int>()).empty());
+
+	auto const lonely = gdwg::page_rank(gdwg::graph<int, int>{1, 2});
+	CHECK(lonely == std::vector<std::pair<int, double>>{{1, 0.5}, {2, 0.5}});
+
+	auto g = gdwg::graph<int, double>{1, 2, 3};
+	g.insert_edge(1, 2, 0.5);
+	g.insert_edge(2, 3, -1.0);
+	CHECK_THROWS_WITH(gdwg::page_rank(g),
+	                  "Cannot call gdwg::page_rank on a graph with negative edge weights");
+}
+
+TEST_CASE("Gather-apply runs a custom program") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.insert_edge("a", "b", 2);
+	g.insert_edge("c", "b", 3);
+	g.insert_edge("b", "a", 4);
+
+	auto const engine = gdwg::gather_apply(g);
+	CHECK(engine.size() == 3);
+	CHECK(engine.out_weight(1) == 4.0);
+
+	auto values = std::vector<double>(3);
+	auto program = in_weight_program();
+	// The second iteration changes nothing, so the run stops there.
+	CHECK(engine.run(values, program, {.threads = 2}) == 2);
+	CHECK(program.starts == 2);
+	CHECK(values == std::vector<double>{4.0, 5.0, 0.0});
+
+	CHECK(engine.run(values, program, {.max_iterations = 0}) == 0);
+	auto wrong_size = std::vector<double>(2);
+	CHECK_THROWS_WITH(engine.run(wrong_size, program),
+	                  "Cannot call gdwg::gather_apply::run without exactly one value per node");
+}
+
+TEST_CASE("Strongly connected components in topological order") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e", "f", "g"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("b", "c", 1);
+	g.insert_edge("c", "a", 1);
+	g.insert_edge("c", "d", 1);
+	g.insert_edge("d", "e", 1);
+	g.insert_edge("e", "d", 1);
+	g.insert_edge("e", "d", 2);
+	g.insert_edge("f", "f", 1);
+	g.insert_edge("f", "a", 1);
+
+	auto const components = gdwg::strongly_connected_components(g);
+	auto const expected = std::vector<std::vector<std::string>>{{"g"},
+	                                                            {"f"},
+	                                                            {"a", "b", "c"},
+	                                                            {"d", "e"}};
+	CHECK(components == expected);
+
+	CHECK(gdwg::strongly_connected_components(gdwg::graph<int, int>()).empty());
+}
+
+TEST_CASE("Strongly connected components match mutual reachability") {
+	auto g = make_skewed_graph(400, 700);
+	for (auto i = 300; i < 320; ++i) {
+		g.erase_node(i);
+	}
+
+	auto component_of = std::map<int, std::size_t>();
+	auto const components = gdwg::strongly_connected_components(g);
+	for (auto c = std::size_t{0}; c < components.size(); ++c) {
+		CHECK(std::is_sorted(components[c].begin(), components[c].end()));
+		for (auto node : components[c]) {
+			component_of[node] = c;
+		}
+	}
+	REQUIRE(component_of.size() == g.nodes().size());
+
+	auto reach = std::map<int, std::vector<int>>();
+	for (auto node : g.nodes()) {
+		reach[node] = gdwg::reachable(g, node);
+	}
+	auto reaches = [&reach](int from, int to) {
+		return std::binary_search(reach[from].begin(), reach[from].end(), to);
+	};
+	for (auto const& [from, to, weight] : g) {
+		CHECK(component_of[from] <= component_of[to]);
+	}
+	for (auto from : g.nodes()) {
+		for (auto to : g.nodes()) {
+			auto const same = reaches(from, to) && reaches(to, from);
+			CHECK((component_of[from] == component_of[to]) == same);
+		}
+	}
+}
+
+TEST_CASE("Topological order and cycles") {
+	auto g = gdwg::graph<std::string, int>{"shirt", "tie", "jacket", "socks", "shoes", "pants"};
+	g.insert_edge("shirt", "tie", 1);
+	g.insert_edge("tie", "jacket", 1);
+	g.insert_edge("pants", "shoes", 1);
+	g.insert_edge("pants", "jacket", 1);
+	g.insert_edge("socks", "shoes", 1);
+	g.insert_edge("socks", "shoes", 2);
+
+	auto const order = gdwg::topological_order(g);
+	REQUIRE(order.has_value());
+	CHECK(std::is_permutation(order->begin(), order->end(), g.nodes().begin()));
+	auto position = std::map<std::string, std::size_t>();
+	for (auto i = std::size_t{0}; i < order->size(); ++i) {
+		position[(*order)[i]] = i;
+	}
+	for (auto const& [from, to, weight] : g) {
+		CHECK(position[from] < position[to]);
+	}
+	CHECK(!gdwg::has_cycle(g));
+
+	g.insert_edge("jacket", "pants", 1);
+	CHECK(!gdwg::topological_order(g).has_value());
+	CHECK(gdwg::has_cycle(g));
+
+	auto loop = gdwg::graph<int, int>{1, 2};
+	loop.insert_edge(1, 2, 0);
+	CHECK(!gdwg::has_cycle(loop));
+	loop.insert_edge(2, 2, 0);
+	CHECK(gdwg::has_cycle(loop));
+}
+
+TEST_CASE("Traversals handle chains too long to recurse along") {
+	constexpr auto n = 200000;
+	auto g = gdwg::graph<int, int>();
+	auto edges = std::vector<gdwg::graph<int, int>::value_type>();
+	for (auto i = 0; i < n; ++i) {
+		g.insert_node(i);
+		if (i + 1 < n) {
+			edges.push_back({i, i + 1, 0});
+		}
+	}
+	g.insert_edges(edges.begin(), edges.end());
+
+	auto workspace = gdwg::traversal_workspace();
+	CHECK(gdwg::strongly_connected_components(g, workspace).size() == n);
+	auto const order = gdwg::topological_order(g, workspace);
+	REQUIRE(order.has_value());
+	CHECK(std::is_sorted(order->begin(), order->end()));
+
+	// Closing the chain makes it one big cycle.
+	g.insert_edge(n - 1, 0, 0);
+	auto const components = gdwg::strongly_connected_components(g, workspace);
+	REQUIRE(components.size() == 1);
+	CHECK(components[0].size() == n);
+	CHECK(gdwg::has_cycle(g, workspace));
+
+	// The same workspace works on a smaller graph afterwards.
+	auto small = gdwg::graph<int, int>{1, 2};
+	small.insert_edge(2, 1, 0);
+	CHECK(gdwg::topological_order(small, workspace) == std::vector<int>{2, 1});
+}
@@ -0,0 +1,174 @@
+#include "gdwg/binary_io.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+namespace {
+	auto make_graph() -> gdwg::graph<int, double> {
+		auto g = gdwg::graph<int, double>{1, 2, 3, 4, 5};
+		g.insert_edge(1, 2, 0.5);
+		g.insert_edge(1, 3, 2.0);
+		g.insert_edge(1, 3, 1.0);
+		g.insert_edge(2, 1, 4.0);
+		g.insert_edge(3, 3, 3.0);
+		g.insert_edge(4, 1, 1.5);
+		return g;
+	}
+
+	auto save(auto const& g) -> std::string {
+		auto out = std::ostringstream(std::ios::binary);
+		gdwg::save_graph(out, g);
+		return out.str();
+	}
+
+	// A file with a name of its own in the temporary directory, removed when it goes out of
+	// scope. Declare it before any graph mapped from it, so the file outlives the mapping.
+	struct temp_file {
+		std::filesystem::path path;
+
+		explicit temp_file(std::string const& contents) {
+			auto name = (std::filesystem::temp_directory_path() / "gdwg_binary_io_test1.XXXXXX")
+			               .string();
+			auto const fd = ::mkstemp(name.data());
+			REQUIRE(fd != -1);
+			::close(fd);
+			path = name;
+			auto out = std::ofstream(path, std::ios::binary);
+			out << contents;
+		}
+
+		temp_file(temp_file const&) = delete;
+		auto operator=(temp_file const&) -> temp_file& = delete;
+
+		~temp_file() {
+			std::filesystem::remove(path);
+		}
+	};
+
+	struct point {
+		int x;
+		int y;
+
+		friend auto operator<=>(point const&, point const&) = default;
+
+		friend auto operator<<(std::ostream& os, point const& value) -> std::ostream& {
+			return os << '(' << value.x << ", " << value.y << ')';
+		}
+	};
+} // namespace
+
+template<>
+struct gdwg::binary_traits<point> {
+	static constexpr auto tag = std::uint64_t{0x706f696e74};
+};
+
+TEST_CASE("Saving and loading a graph gives back the same graph") {
+	auto const g = make_graph();
+	auto in = std::istringstream(save(g), std::ios::binary);
+	auto const loaded = gdwg::load_graph<int, double>(in);
+	CHECK(loaded == g);
+}
+
+TEST_CASE("Saving and loading a graph of strings") {
+	auto g = gdwg::graph<std::string, std::string>{"hello", "how", "", "a much longer node value"};
+	g.insert_edge("hello", "how", "first");
+	g.insert_edge("hello", "", "");
+	g.insert_edge("", "a much longer node value", "second");
+	auto in = std::istringstream(save(g), std::ios::binary);
+	CHECK(gdwg::load_graph<std::string, std::string>(in) == g);
+}
+
+TEST_CASE("Saving and loading trivially copyable custom types") {
+	auto g = gdwg::graph<point, int>{{1, 2}, {3, 4}};
+	g.insert_edge({1, 2}, {3, 4}, 7);
+	auto in = std::istringstream(save(g), std::ios::binary);
+	CHECK(gdwg::load_graph<point, int>(in) == g);
+}
+
+TEST_CASE("Saving and loading an empty graph") {
+	auto in = std::istringstream(save(gdwg::graph<int, int>{}), std::ios::binary);
+	CHECK(gdwg::load_graph<int, int>(in).empty());
+}
+
+TEST_CASE("Loading checks the header") {
+	auto const bytes = save(make_graph());
+
+	SECTION("Different types") {
+		auto in = std::istringstream(bytes, std::ios::binary);
+		CHECK_THROWS_MATCHES((gdwg::load_graph<int, float>(in)),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::load_graph on a graph file "
+		                                              "saved with different node or weight types"));
+	}
+
+	SECTION("Not a graph file") {
+		auto in = std::istringstream(std::string(200, 'x'), std::ios::binary);
+		CHECK_THROWS_MATCHES((gdwg::load_graph<int, double>(in)),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::load_graph on data that "
+		                                              "isn't a graph file"));
+	}
+
+	SECTION("Truncated") {
+		auto in = std::istringstream(bytes.substr(0, bytes.size() - 1), std::ios::binary);
+		CHECK_THROWS_MATCHES((gdwg::load_graph<int, double>(in)),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::load_graph on a truncated "
+		                                              "graph file"));
+	}
+}
+
+TEST_CASE("A mapped graph answers the same queries as the graph") {
+	auto const g = make_graph();
+	auto const file = temp_file(save(g));
+	auto const mapped = gdwg::mapped_graph<int, double>(file.path);
+
+	CHECK(!mapped.empty());
+	CHECK(std::vector(mapped.nodes().begin(), mapped.nodes().end()) == g.nodes());
+	for (auto const src : g.nodes()) {
+		CHECK(mapped.is_node(src));
+		CHECK(mapped.connections(src) == g.connections(src));
+		for (auto const dst : g.nodes()) {
+			CHECK(mapped.is_connected(src, dst) == g.is_connected(src, dst));
+			CHECK(mapped.weights(src, dst) == g.weights(src, dst));
+		}
+	}
+	CHECK(!mapped.is_node(6));
+	CHECK_THROWS_MATCHES(mapped.weights(1, 6),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::mapped_graph<N, E>::weights if "
+	                                              "src or dst node don't exist in the graph"));
+}
+
+TEST_CASE("Moving a mapped graph keeps the mapping alive") {
+	auto const file = temp_file(save(make_graph()));
+	auto const empty_file = temp_file(save(gdwg::graph<int, double>{}));
+	CHECK(file.path != empty_file.path);
+
+	auto mapped = gdwg::mapped_graph<int, double>(file.path);
+	auto moved = std::move(mapped);
+	CHECK(moved.weights(1, 3) == std::vector<double>{1.0, 2.0});
+
+	moved = gdwg::mapped_graph<int, double>(empty_file.path);
+	CHECK(moved.empty());
+}
+
+TEST_CASE("Mapping checks the header") {
+	auto const file = temp_file(save(make_graph()));
+	CHECK_THROWS_AS((gdwg::mapped_graph<int, int>(file.path)), std::runtime_error);
+
+	auto const empty = temp_file("");
+	CHECK_THROWS_MATCHES((gdwg::mapped_graph<int, double>(empty.path)),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call "
+	                                              "gdwg::mapped_graph<N, E>::mapped_graph on data "
+	                                              "that isn't a graph file"));
+
+	CHECK_THROWS_AS((gdwg::mapped_graph<int, double>("/nonexistent/graph.bin")), std::system_error);
+}
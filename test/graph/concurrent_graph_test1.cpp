@@ -0,0 +1,85 @@
+#include "gdwg/concurrent_graph.hpp"
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Snapshots don't see later updates") {
+	auto g = gdwg::concurrent_graph<std::string, int>();
+	CHECK(g.insert_node("hello"));
+	CHECK(g.insert_node("how"));
+	CHECK_FALSE(g.insert_node("how"));
+	CHECK(g.insert_edge("hello", "how", 5));
+
+	auto const before = g.snapshot();
+	CHECK(g.erase_edge("hello", "how", 5));
+	CHECK(g.replace_node("how", "are"));
+
+	CHECK(before->is_connected("hello", "how"));
+	CHECK(before->nodes() == std::vector<std::string>{"hello", "how"});
+
+	auto const after = g.snapshot();
+	CHECK(after->nodes() == std::vector<std::string>{"are", "hello"});
+	CHECK_FALSE(after->is_connected("hello", "are"));
+}
+
+TEST_CASE("Updates are published whole or not at all") {
+	auto g = gdwg::concurrent_graph<int, int>(gdwg::graph<int, int>{1, 2, 3});
+
+	auto const inserted = g.update([](auto& graph) {
+		return graph.insert_edges({{1, 2, 1}, {2, 3, 1}, {2, 3, 1}});
+	});
+	CHECK(inserted == 2);
+
+	CHECK_THROWS_AS(g.update([](auto& graph) {
+		graph.insert_edge(3, 1, 1);
+		graph.insert_edge(3, 4, 1);
+	}),
+	                std::runtime_error);
+	CHECK_FALSE(g.snapshot()->is_connected(3, 1));
+
+	g.merge_replace_node(3, 2);
+	CHECK(g.snapshot()->weights(2, 2) == std::vector<int>{1});
+	CHECK(g.erase_node(1));
+	CHECK(g.snapshot()->nodes() == std::vector<int>{2});
+}
+
+TEST_CASE("Readers run alongside a writer") {
+	constexpr auto length = 200;
+	auto g = gdwg::concurrent_graph<int, int>(gdwg::graph<int, int>{0});
+	auto done = std::atomic<bool>(false);
+
+	// The writer grows a chain one node at a time, so every snapshot must be a whole chain.
+	auto readers = std::vector<std::jthread>();
+	auto failures = std::atomic<int>(0);
+	for (auto i = 0; i < 3; ++i) {
+		readers.emplace_back([&] {
+			while (!done.load()) {
+				auto const snapshot = g.snapshot();
+				auto const nodes = snapshot->nodes();
+				auto const edges = std::distance(snapshot->begin(), snapshot->end());
+				if (edges + 1 != static_cast<std::ptrdiff_t>(nodes.size())
+				    || !snapshot->is_node(static_cast<int>(nodes.size()) - 1))
+				{
+					++failures;
+				}
+			}
+		});
+	}
+
+	for (auto i = 1; i < length; ++i) {
+		g.update([i](auto& graph) {
+			graph.insert_node(i);
+			graph.insert_edge(i - 1, i, i);
+		});
+	}
+	done = true;
+	readers.clear();
+
+	CHECK(failures == 0);
+	CHECK(g.snapshot()->connections(length - 2) == std::vector<int>{length - 1});
+}
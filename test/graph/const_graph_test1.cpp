@@ -0,0 +1,139 @@
+#include "gdwg/graph.hpp"
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Counts every allocation in the program, so a test can check that a query makes none.
+namespace {
+	auto allocations = std::atomic<std::size_t>{0};
+} // namespace
+
+auto operator new(std::size_t size) -> void* {
+	++allocations;
+	if (auto* p = std::malloc(size == 0 ? 1 : size)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+auto operator new[](std::size_t size) -> void* {
+	return ::operator new(size);
+}
+
+auto operator new(std::size_t size, std::nothrow_t const&) noexcept -> void* {
+	++allocations;
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+auto operator new[](std::size_t size, std::nothrow_t const& tag) noexcept -> void* {
+	return ::operator new(size, tag);
+}
+
+auto operator delete(void* p) noexcept -> void {
+	std::free(p);
+}
+
+auto operator delete[](void* p) noexcept -> void {
+	std::free(p);
+}
+
+auto operator delete(void* p, std::size_t) noexcept -> void {
+	std::free(p);
+}
+
+auto operator delete[](void* p, std::size_t) noexcept -> void {
+	std::free(p);
+}
+
+auto operator delete(void* p, std::nothrow_t const&) noexcept -> void {
+	std::free(p);
+}
+
+auto operator delete[](void* p, std::nothrow_t const&) noexcept -> void {
+	std::free(p);
+}
+
+namespace {
+	auto make_graph(gdwg::in_edge_index index) -> gdwg::graph<std::string, int> {
+		auto g = gdwg::graph<std::string, int>(index);
+		for (auto i = 0; i < 64; ++i) {
+			g.insert_node("node number " + std::to_string(i));
+		}
+		for (auto i = 0; i < 512; ++i) {
+			g.insert_edge("node number " + std::to_string(i % 64),
+			              "node number " + std::to_string(i * 7 % 64),
+			              i % 5);
+		}
+		return g;
+	}
+} // namespace
+
+TEST_CASE("Queries allocate nothing but what they return") {
+	for (auto index : {gdwg::in_edge_index::enabled, gdwg::in_edge_index::disabled}) {
+		auto const g = make_graph(index);
+		auto const copy = g;
+		auto const src = std::string("node number 3");
+		auto const dst = std::string("node number 21");
+
+		auto const before = allocations.load();
+		auto found = 0;
+		found += g.is_node(src) ? 1 : 0;
+		found += g.empty() ? 0 : 1;
+		found += g.is_connected(src, dst) ? 1 : 0;
+		found += g.find(src, dst, 3) != g.end() ? 1 : 0;
+		found += static_cast<int>(g.in_degree(dst));
+		found += static_cast<int>(std::ranges::distance(g.out_edges(src)));
+		found += static_cast<int>(std::ranges::distance(g.neighbors(src)));
+		found += static_cast<int>(std::ranges::distance(g.edges_between(src, dst)));
+		found += static_cast<int>(std::distance(g.begin(), g.end()));
+		found += g == copy ? 1 : 0;
+		auto const after = allocations.load();
+
+		CHECK(found > 0);
+		CHECK(after == before);
+
+		// The node values are short enough to be stored inside their strings.
+		auto const returned = allocations.load();
+		auto const weights = g.weights(src, dst);
+		auto const nodes = g.nodes();
+		CHECK(allocations.load() - returned == 2);
+		CHECK(!weights.empty());
+	}
+}
+
+TEST_CASE("Many threads can query one const graph") {
+	for (auto index : {gdwg::in_edge_index::enabled, gdwg::in_edge_index::disabled}) {
+		auto const g = make_graph(index);
+		auto const nodes = g.nodes();
+
+		// Each thread computes the same answers; they should all agree with a single thread.
+		auto const answer = [&g, &nodes] {
+			auto ret = std::size_t{0};
+			for (auto const& src : nodes) {
+				ret += g.connections(src).size() + g.predecessors(src).size() + g.in_degree(src);
+				for (auto const& dst : g.neighbors(src)) {
+					ret += g.weights(src, dst).size() + (g.is_connected(dst, src) ? 1 : 0);
+				}
+			}
+			return ret;
+		};
+		auto const expected = answer();
+
+		auto results = std::vector<std::size_t>(4);
+		{
+			auto threads = std::vector<std::jthread>();
+			for (auto& result : results) {
+				threads.emplace_back([&result, &answer] { result = answer(); });
+			}
+		}
+		for (auto const result : results) {
+			CHECK(result == expected);
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#include "gdwg/csr_graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <sstream>
+
+namespace {
+	auto make_graph() -> gdwg::graph<std::string, int> {
+		auto g = gdwg::graph<std::string, int>{"hello", "how", "are", "you?", "alone"};
+		g.insert_edge("hello", "how", 5);
+		g.insert_edge("hello", "are", 8);
+		g.insert_edge("hello", "are", 2);
+		g.insert_edge("how", "you?", 1);
+		g.insert_edge("how", "hello", 4);
+		g.insert_edge("are", "you?", 3);
+		return g;
+	}
+} // namespace
+
+TEST_CASE("Freezing an empty graph") {
+	auto const csr = gdwg::csr_graph{gdwg::graph<int, int>{}};
+	CHECK(csr.empty());
+	CHECK(csr.begin() == csr.end());
+}
+
+TEST_CASE("Frozen graph answers the same queries as the graph") {
+	auto g = make_graph();
+	auto const csr = gdwg::csr_graph{g};
+
+	CHECK(!csr.empty());
+	CHECK(csr.nodes() == g.nodes());
+	CHECK(csr.is_node("alone"));
+	CHECK(!csr.is_node("missing"));
+
+	CHECK(csr.is_connected("hello", "are"));
+	CHECK(!csr.is_connected("are", "hello"));
+	CHECK(csr.weights("hello", "are") == std::vector<int>{2, 8});
+	CHECK(csr.weights("alone", "hello").empty());
+	CHECK(csr.connections("hello") == g.connections("hello"));
+	CHECK(csr.connections("alone").empty());
+
+	REQUIRE_THROWS_WITH(csr.is_connected("hello", "missing"),
+	                    "Cannot call gdwg::csr_graph<N, E>::is_connected if src or dst node don't "
+	                    "exist in the graph");
+	REQUIRE_THROWS_WITH(csr.weights("missing", "hello"),
+	                    "Cannot call gdwg::csr_graph<N, E>::weights if src or dst node don't exist "
+	                    "in the graph");
+	REQUIRE_THROWS_WITH(csr.connections("missing"),
+	                    "Cannot call gdwg::csr_graph<N, E>::connections if src doesn't exist in the "
+	                    "graph");
+}
+
+TEST_CASE("Frozen graph iterates and prints like the graph") {
+	auto g = make_graph();
+	auto const csr = gdwg::csr_graph{g};
+
+	auto it = g.begin();
+	for (auto const& [from, to, weight] : csr) {
+		REQUIRE(it != g.end());
+		auto const expected = *it++;
+		CHECK(from == expected.from);
+		CHECK(to == expected.to);
+		CHECK(weight == expected.weight);
+	}
+	CHECK(it == g.end());
+
+	auto last = csr.end();
+	--last;
+	CHECK((*last).from == "how");
+	CHECK((*last).to == "you?");
+
+	CHECK(csr.find("hello", "are", 8) == ++csr.find("hello", "are", 2));
+	CHECK(csr.find("hello", "are", 3) == csr.end());
+	CHECK(csr.find("missing", "are", 3) == csr.end());
+
+	auto expected = std::ostringstream{};
+	expected << g;
+	auto actual = std::ostringstream{};
+	actual << csr;
+	CHECK(actual.str() == expected.str());
+}
+
+static_assert(std::bidirectional_iterator<gdwg::csr_graph<std::string, int>::iterator>);
@@ -1,7 +1,18 @@
 #include "gdwg/graph.hpp"
+#include "gdwg/posix_io.hpp"
 
+#include <algorithm>
+#include <array>
 #include <catch2/catch.hpp>
+#include <functional>
+#include <memory_resource>
+#include <ranges>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
 
 TEST_CASE("Default constructor") {
 	auto g = gdwg::graph<std::string, int>{};
@@ -521,4 +532,868 @@ TEST_CASE("Custom iterator") {
 	CHECK(firstEdge == g.begin());
 	CHECK(!(firstEdge == g.end()));
 	CHECK(firstEdge != g.end());
-}
\ No newline at end of file
+}
+
+namespace {
+	// Counts how many times a node value is copied, so lookups can be checked for throwaway keys.
+	struct counted {
+		int value;
+		static inline int copies = 0;
+
+		counted(int v)
+		: value{v} {}
+		counted(counted const& other)
+		: value{other.value} {
+			++copies;
+		}
+		auto operator=(counted const& other) -> counted& = default;
+
+		auto operator==(counted const& other) const -> bool {
+			return value == other.value;
+		}
+		auto operator<(counted const& other) const -> bool {
+			return value < other.value;
+		}
+	};
+} // namespace
+
+TEST_CASE("Lookups do not copy node values") {
+	auto g = gdwg::graph<counted, int>{};
+	auto const a = counted{1};
+	auto const b = counted{2};
+	g.insert_node(a);
+	g.insert_node(b);
+	g.insert_edge(a, b, 3);
+
+	counted::copies = 0;
+	CHECK(g.is_node(a));
+	CHECK(!g.insert_node(a));
+	CHECK(!g.insert_edge(a, b, 3));
+	CHECK(g.is_connected(a, b));
+	CHECK(g.weights(a, b) == std::vector<int>{3});
+	CHECK(g.find(a, b, 3) == g.begin());
+	CHECK(g.erase_edge(a, b, 3));
+	CHECK(counted::copies == 0);
+}
+
+TEST_CASE("Erase node removes its incoming, outgoing and self edges") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("b", "b", 2);
+	g.insert_edge("b", "c", 3);
+	g.insert_edge("c", "b", 4);
+	g.insert_edge("c", "a", 5);
+
+	CHECK(g.erase_node("b"));
+	CHECK(g.connections("a").empty());
+	CHECK(g.connections("c") == std::vector<std::string>{"a"});
+	CHECK(std::distance(g.begin(), g.end()) == 1);
+
+	// The remaining edges can still be erased through the incoming lists of their targets.
+	CHECK(g.erase_node("a"));
+	CHECK(g.begin() == g.end());
+}
+
+TEST_CASE("Merge replace node keeps the new node's edges") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "a", 2);
+	g.insert_edge("b", "c", 3);
+	g.insert_edge("c", "a", 4);
+	g.insert_edge("c", "b", 4);
+
+	g.merge_replace_node("a", "b");
+	CHECK(!g.is_node("a"));
+	CHECK(g.weights("b", "b") == std::vector<int>{1, 2});
+	CHECK(g.weights("b", "c") == std::vector<int>{3});
+	CHECK(g.weights("c", "b") == std::vector<int>{4});
+
+	g.merge_replace_node("b", "b");
+	CHECK(g.is_node("b"));
+	CHECK(std::distance(g.begin(), g.end()) == 4);
+}
+
+TEST_CASE("Insert edges in bulk") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.insert_edge("b", "c", 1);
+
+	auto const batch = std::vector<gdwg::graph<std::string, int>::value_type>{
+	   {"c", "a", 2},
+	   {"a", "b", 3},
+	   {"b", "c", 1},
+	   {"a", "b", 3},
+	   {"a", "a", 1},
+	   {"b", "c", 0},
+	};
+	CHECK(g.insert_edges(batch.begin(), batch.end()) == 4);
+	CHECK(g.weights("a", "b") == std::vector<int>{3});
+	CHECK(g.weights("b", "c") == std::vector<int>{0, 1});
+	CHECK(g.connections("a") == std::vector<std::string>{"a", "b"});
+	CHECK(std::distance(g.begin(), g.end()) == 5);
+
+	// Bulk-inserted edges are indexed like any other, so erasing a node removes them.
+	g.erase_node("a");
+	CHECK(g.connections("c").empty());
+
+	REQUIRE_THROWS_WITH(g.insert_edges({{"b", "c", 5}, {"b", "missing", 1}}),
+	                    "Cannot call gdwg::graph<N, E>::insert_edges when either src or dst node "
+	                    "does not exist");
+	CHECK(g.weights("b", "c") == std::vector<int>{0, 1});
+}
+
+TEST_CASE("Small batches into a big graph look their endpoints up") {
+	auto g = gdwg::graph<int, int>();
+	for (auto i = 0; i < 10000; ++i) {
+		g.insert_node(i);
+	}
+	auto expected = g;
+
+	for (auto i = 0; i < 50; ++i) {
+		auto const batch = std::vector<gdwg::graph<int, int>::value_type>{
+		   {(i * 7919) % 10000, (i * 104729) % 10000, i},
+		   {9999 - i, i, 1},
+		   {9999 - i, i, 1},
+		};
+		CHECK(g.insert_edges(batch.begin(), batch.end()) == 2);
+		for (auto const& [from, to, weight] : batch) {
+			expected.insert_edge(from, to, weight);
+		}
+	}
+	CHECK(g == expected);
+	CHECK(g.predecessors(0) == expected.predecessors(0));
+
+	REQUIRE_THROWS_WITH(g.insert_edges({{1, 2, 5}, {3, -1, 1}}),
+	                    "Cannot call gdwg::graph<N, E>::insert_edges when either src or dst node "
+	                    "does not exist");
+	CHECK(g == expected);
+}
+
+TEST_CASE("Copies own their nodes and edges") {
+	auto g1 = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g1.insert_edges({{"a", "b", 1}, {"b", "c", 2}, {"c", "a", 3}, {"c", "c", 4}});
+
+	auto g2 = g1;
+	CHECK(g2 == g1);
+
+	auto g3 = gdwg::graph<std::string, int>{"z"};
+	g3 = g1;
+	CHECK(g3 == g1);
+	g3 = g3;
+	CHECK(g3 == g1);
+
+	// Erasing from a copy walks the copy's own incoming lists and leaves the original alone.
+	g2.erase_node("c");
+	CHECK(g2.connections("b").empty());
+	CHECK(g1.connections("b") == std::vector<std::string>{"c"});
+	g3.merge_replace_node("c", "a");
+	CHECK(g3.weights("a", "a") == std::vector<int>{3, 4});
+	CHECK(g1.weights("c", "c") == std::vector<int>{4});
+}
+
+TEST_CASE("Moved-from graphs can be reused") {
+	auto g1 = gdwg::graph<std::string, int>{"a", "b"};
+	g1.insert_edge("a", "b", 1);
+	auto g2 = std::move(g1);
+
+	g1.insert_node("c");
+	g1.insert_node("d");
+	g1.insert_edge("d", "c", 2);
+	CHECK(g1.nodes() == std::vector<std::string>{"c", "d"});
+	CHECK(g1.weights("d", "c") == std::vector<int>{2});
+	CHECK(g2.weights("a", "b") == std::vector<int>{1});
+}
+
+TEST_CASE("Nodes inserted after an erase keep edges in value order") {
+	auto g = gdwg::graph<std::string, int>{"b", "d", "f"};
+	g.insert_edges({{"b", "d", 1}, {"d", "f", 2}, {"f", "b", 3}});
+	g.erase_node("d");
+	g.insert_node("a");
+	g.insert_node("e");
+	g.insert_edges({{"b", "e", 4}, {"b", "a", 5}, {"e", "f", 6}});
+
+	auto out = std::ostringstream{};
+	out << g;
+	CHECK(out.str() == "a (\n)\nb (\n  a | 5\n  e | 4\n)\ne (\n  f | 6\n)\nf (\n  b | 3\n)\n");
+}
+
+namespace {
+	// Forwards to the default resource while keeping a running count of outstanding bytes.
+	class counting_resource : public std::pmr::memory_resource {
+	public:
+		std::size_t outstanding = 0;
+		std::size_t allocations = 0;
+
+	private:
+		auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override {
+			outstanding += bytes;
+			++allocations;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+		auto do_deallocate(void* p, std::size_t bytes, std::size_t alignment) -> void override {
+			outstanding -= bytes;
+			std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+		auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override {
+			return this == &other;
+		}
+	};
+} // namespace
+
+TEST_CASE("Graph storage comes from its allocator") {
+	auto resource = counting_resource{};
+	{
+		auto g = gdwg::pmr::graph<int, int>({1, 2, 3}, &resource);
+		g.insert_edges({{1, 2, 1}, {2, 3, 2}, {3, 1, 3}});
+		g.insert_edge(1, 1, 4);
+		CHECK(resource.allocations > 0);
+		CHECK(g.get_allocator().resource() == &resource);
+
+		auto const before = resource.allocations;
+		auto moved = std::move(g);
+		CHECK(resource.allocations == before);
+
+		auto other = counting_resource{};
+		auto copy = gdwg::pmr::graph<int, int>(&other);
+		copy = moved;
+		CHECK(copy == moved);
+		CHECK(copy.get_allocator().resource() == &other);
+		CHECK(other.outstanding > 0);
+
+		copy = std::move(moved);
+		CHECK(copy.get_allocator().resource() == &other);
+		CHECK(copy.weights(3, 1) == std::vector<int>{3});
+		copy.erase_node(1);
+		CHECK(copy.connections(3).empty());
+	}
+	CHECK(resource.outstanding == 0);
+}
+
+TEST_CASE("Graphs can live in a monotonic arena") {
+	auto arena = std::pmr::monotonic_buffer_resource{};
+	auto g = gdwg::pmr::graph<std::string, double>(&arena);
+	g.insert_node("a");
+	g.insert_node("b");
+	g.insert_edge("a", "b", 0.5);
+	g.clear();
+	CHECK(g.empty());
+	g.insert_node("c");
+	CHECK(g.nodes() == std::vector<std::string>{"c"});
+}
+
+static_assert(std::bidirectional_iterator<gdwg::graph<std::string, int>::iterator>);
+static_assert(std::ranges::bidirectional_range<gdwg::graph<std::string, int> const>);
+
+TEST_CASE("Iterators refer to the graph's values without copying them") {
+	auto g = gdwg::graph<std::string, std::string>{"hello", "how"};
+	g.insert_edge("hello", "how", "five");
+	g.insert_edge("how", "hello", "four");
+
+	auto const first = *g.begin();
+	auto const again = *g.begin();
+	CHECK(&first.from == &again.from);
+	CHECK(&first.weight == &again.weight);
+	CHECK(first.weight == "five");
+
+	auto edges = std::vector<gdwg::graph<std::string, std::string>::value_type>(g.begin(), g.end());
+	CHECK(edges.back().from == "how");
+	CHECK(edges.back().weight == "four");
+
+	auto reversed = std::vector<std::string>();
+	for (auto const& [from, to, weight] : g | std::views::reverse) {
+		reversed.push_back(from + "->" + to + ":" + weight);
+	}
+	CHECK(reversed == std::vector<std::string>{"how->hello:four", "hello->how:five"});
+
+	auto const it = std::ranges::find_if(g, [](auto const& edge) { return edge.to == "hello"; });
+	CHECK((*it).weight == "four");
+}
+
+TEST_CASE("Views over a node's edges") {
+	auto g = gdwg::graph<std::string, int>{"hello", "how", "are", "you?"};
+	g.insert_edge("hello", "how", 5);
+	g.insert_edge("hello", "are", 8);
+	g.insert_edge("hello", "are", 2);
+	g.insert_edge("how", "you?", 1);
+	g.insert_edge("how", "hello", 4);
+	g.insert_edge("are", "you?", 3);
+
+	static_assert(std::ranges::forward_range<decltype(g.neighbors("hello"))>);
+	static_assert(std::ranges::sized_range<decltype(g.out_edges("hello"))>);
+
+	auto out = std::vector<std::string>();
+	for (auto const& [from, to, weight] : g.out_edges("hello")) {
+		out.push_back(from + "->" + to + ":" + std::to_string(weight));
+	}
+	CHECK(out == std::vector<std::string>{"hello->are:2", "hello->are:8", "hello->how:5"});
+	CHECK(g.out_edges("hello").size() == 3);
+	CHECK(g.out_edges("you?").empty());
+
+	auto in = std::vector<std::string>();
+	for (auto const& [from, to, weight] : g.in_edges("you?")) {
+		in.push_back(from + ":" + std::to_string(weight));
+	}
+	std::sort(in.begin(), in.end());
+	CHECK(in == std::vector<std::string>{"are:3", "how:1"});
+
+	auto const neighbors = g.neighbors("hello") | std::views::common;
+	CHECK(std::vector<std::string>(neighbors.begin(), neighbors.end()) == g.connections("hello"));
+	CHECK(g.neighbors("you?").empty());
+
+	auto between = std::vector<int>();
+	for (auto const& edge : g.edges_between("hello", "are")) {
+		between.push_back(edge.weight);
+	}
+	CHECK(between == g.weights("hello", "are"));
+	CHECK(g.edges_between("are", "hello").empty());
+	CHECK(g.edges_between("hello", "are").begin() == g.find("hello", "are", 2));
+
+	auto heavy = g.out_edges("hello")
+	             | std::views::filter([](auto const& e) { return e.weight > 4; })
+	             | std::views::transform([](auto const& e) { return e.weight; })
+	             | std::views::common;
+	CHECK(std::vector<int>(heavy.begin(), heavy.end()) == std::vector<int>{8, 5});
+
+	CHECK_THROWS_WITH(g.out_edges("nope"),
+	                  "Cannot call gdwg::graph<N, E>::out_edges if src doesn't exist in the graph");
+	CHECK_THROWS_WITH(g.in_edges("nope"),
+	                  "Cannot call gdwg::graph<N, E>::in_edges if dst doesn't exist in the graph");
+	CHECK_THROWS_WITH(g.neighbors("nope"),
+	                  "Cannot call gdwg::graph<N, E>::neighbors if src doesn't exist in the graph");
+	CHECK_THROWS_WITH(g.edges_between("hello", "nope"),
+	                  "Cannot call gdwg::graph<N, E>::edges_between if src or dst node don't exist "
+	                  "in the graph");
+}
+
+TEST_CASE("Views allocate nothing") {
+	auto resource = counting_resource{};
+	auto g = gdwg::pmr::graph<int, int>({1, 2, 3}, &resource);
+	g.insert_edge(1, 2, 1);
+	g.insert_edge(1, 2, 2);
+	g.insert_edge(1, 3, 1);
+	g.insert_edge(3, 1, 1);
+
+	auto const before = resource.allocations;
+	auto sum = 0;
+	for (auto const& edge : g.out_edges(1)) {
+		sum += edge.weight;
+	}
+	for (auto const& edge : g.in_edges(1)) {
+		sum += edge.weight;
+	}
+	for (auto to : g.neighbors(1)) {
+		sum += to;
+	}
+	for (auto const& edge : g.edges_between(1, 2)) {
+		sum += edge.weight;
+	}
+	CHECK(sum == 4 + 1 + 5 + 3);
+	CHECK(resource.allocations == before);
+}
+
+TEST_CASE("Predecessors and in-degree") {
+	for (auto index : {gdwg::in_edge_index::enabled, gdwg::in_edge_index::disabled}) {
+		auto g = gdwg::graph<std::string, int>(index);
+		CHECK(g.in_edges_indexed() == (index == gdwg::in_edge_index::enabled));
+		for (auto const* value : {"hello", "how", "are", "you?"}) {
+			g.insert_node(value);
+		}
+		g.insert_edge("hello", "how", 5);
+		g.insert_edge("hello", "are", 8);
+		g.insert_edge("hello", "are", 2);
+		g.insert_edge("how", "you?", 1);
+		g.insert_edge("how", "hello", 4);
+		g.insert_edge("are", "you?", 3);
+		g.insert_edge("you?", "you?", 3);
+
+		CHECK(g.predecessors("you?") == std::vector<std::string>{"are", "how", "you?"});
+		CHECK(g.predecessors("are") == std::vector<std::string>{"hello"});
+		CHECK(g.in_degree("are") == 2);
+		CHECK(g.in_degree("you?") == 3);
+		CHECK(g.in_degree("hello") == 1);
+
+		auto copy = g;
+		CHECK(copy.in_edges_indexed() == g.in_edges_indexed());
+
+		g.merge_replace_node("are", "how");
+		CHECK(g.predecessors("you?") == std::vector<std::string>{"how", "you?"});
+		CHECK(g.in_degree("you?") == 3);
+		CHECK(g.weights("hello", "how") == std::vector<int>{2, 5, 8});
+
+		g.erase_node("you?");
+		CHECK(g.connections("how") == std::vector<std::string>{"hello"});
+		CHECK(std::distance(g.begin(), g.end()) == 4);
+
+		CHECK_THROWS_WITH(g.predecessors("nope"),
+		                  "Cannot call gdwg::graph<N, E>::predecessors if dst doesn't exist in the "
+		                  "graph");
+		CHECK_THROWS_WITH(g.in_degree("nope"),
+		                  "Cannot call gdwg::graph<N, E>::in_degree if dst doesn't exist in the "
+		                  "graph");
+	}
+
+	auto unindexed = gdwg::graph<int, int>(gdwg::in_edge_index::disabled);
+	unindexed.insert_node(1);
+	CHECK_THROWS_WITH(unindexed.in_edges(1),
+	                  "Cannot call gdwg::graph<N, E>::in_edges on a graph without an in-edge index");
+}
+
+TEST_CASE("Transactions apply their changes together") {
+	auto g = gdwg::graph<std::string, int>{"hello", "how", "are", "you?"};
+	g.insert_edge("hello", "how", 5);
+	g.insert_edge("hello", "are", 8);
+	g.insert_edge("how", "you?", 1);
+	g.insert_edge("are", "you?", 3);
+
+	auto batch = g.batch();
+	batch.insert_node("there")
+	   .insert_node("there")
+	   .insert_edge("there", "hello", 1)
+	   .insert_edge("hello", "how", 2)
+	   .erase_edge("hello", "how", 5)
+	   .erase_edge("hello", "how", 6)
+	   .erase_node("are")
+	   .erase_node("missing")
+	   .merge_replace_node("you?", "how");
+	CHECK(g.nodes().size() == 4);
+
+	batch.commit();
+	CHECK(g.nodes() == std::vector<std::string>{"hello", "how", "there"});
+	CHECK(g.weights("hello", "how") == std::vector<int>{2});
+	CHECK(g.weights("how", "how") == std::vector<int>{1});
+	CHECK(g.weights("there", "hello") == std::vector<int>{1});
+	CHECK(std::distance(g.begin(), g.end()) == 3);
+
+	batch.commit();
+	CHECK(std::distance(g.begin(), g.end()) == 3);
+}
+
+TEST_CASE("A transaction with an invalid change changes nothing") {
+	auto g = gdwg::graph<int, int>{1, 2, 3};
+	g.insert_edge(1, 2, 1);
+	auto const before = g;
+
+	auto batch = g.batch();
+	batch.insert_node(4).erase_node(3).insert_edge(4, 3, 1);
+	CHECK_THROWS_WITH(batch.commit(),
+	                  "Cannot call gdwg::graph<N, E>::transaction::commit when either src or dst of "
+	                  "an inserted edge does not exist");
+	CHECK(g == before);
+
+	auto merges = g.batch();
+	merges.merge_replace_node(1, 2).merge_replace_node(1, 3);
+	CHECK_THROWS_WITH(merges.commit(),
+	                  "Cannot call gdwg::graph<N, E>::transaction::commit when a replaced node "
+	                  "doesn't exist");
+	CHECK(g == before);
+
+	{
+		auto discarded = g.batch();
+		discarded.erase_node(1);
+	}
+	CHECK(g == before);
+}
+
+TEST_CASE("Transactions replace nodes like the graph does") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("c", "a", 2);
+
+	auto batch = g.batch();
+	// "b" already exists, so the first replacement does nothing, as `graph::replace_node` would.
+	batch.replace_node("a", "b").replace_node("a", "d").replace_node("d", "e");
+	batch.insert_edge("e", "e", 3);
+	batch.commit();
+	CHECK(g.nodes() == std::vector<std::string>{"b", "c", "e"});
+	CHECK(g.weights("e", "b") == std::vector<int>{1});
+	CHECK(g.weights("c", "e") == std::vector<int>{2});
+	CHECK(g.weights("e", "e") == std::vector<int>{3});
+
+	auto const before = g;
+	batch.replace_node("e", "f").replace_node("e", "g");
+	CHECK_THROWS_WITH(batch.commit(),
+	                  "Cannot call gdwg::graph<N, E>::transaction::commit when a replaced node "
+	                  "doesn't exist");
+	CHECK(g == before);
+}
+
+TEST_CASE("Transactions merge nodes like the graph does") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("c", "a", 2);
+	auto expected = g;
+	expected.merge_replace_node("a", "b");
+
+	auto batch = g.batch();
+	batch.merge_replace_node("a", "b");
+	batch.commit();
+	CHECK(g == expected);
+	CHECK(g.weights("b", "b") == std::vector<int>{1});
+
+	auto const before = g;
+	batch.merge_replace_node("b", "d");
+	CHECK_THROWS_WITH(batch.commit(),
+	                  "Cannot call gdwg::graph<N, E>::transaction::commit when a replaced node "
+	                  "doesn't exist");
+	CHECK(g == before);
+}
+
+TEST_CASE("Transactions match applying the same changes one at a time") {
+	for (auto index : {gdwg::in_edge_index::enabled, gdwg::in_edge_index::disabled}) {
+		auto g = gdwg::graph<int, int>(index);
+		for (auto i = 0; i < 50; ++i) {
+			g.insert_node(i);
+		}
+		for (auto i = 0; i < 400; ++i) {
+			g.insert_edge(i * 7 % 50, i * 13 % 50, i % 5);
+		}
+		auto expected = g;
+
+		auto batch = g.batch();
+		for (auto i = 0; i < 50; i += 3) {
+			batch.erase_edge(i, i * 13 % 50, i % 5);
+			expected.erase_edge(i, i * 13 % 50, i % 5);
+		}
+		for (auto i = 0; i < 50; i += 7) {
+			batch.erase_node(i);
+			expected.erase_node(i);
+		}
+		for (auto i = 1; i < 50; i += 7) {
+			batch.insert_edge(i, i + 1, 9);
+			expected.insert_edge(i, i + 1, 9);
+		}
+		batch.commit();
+		CHECK(g == expected);
+	}
+}
+
+TEST_CASE("Reading a graph back from its output") {
+	auto g = gdwg::graph<int, double>{1, 2, 3, 64};
+	g.insert_edge(1, 2, 0.5);
+	g.insert_edge(1, 3, -2);
+	g.insert_edge(1, 3, 1.25);
+	g.insert_edge(3, 1, 1e-3);
+	g.insert_edge(3, 3, 7);
+	auto out = std::ostringstream{};
+	out << g;
+
+	auto in = std::istringstream(out.str());
+	auto const read = gdwg::read_graph<int, double>(in);
+	CHECK(read == g);
+	CHECK(in.eof());
+}
+
+TEST_CASE("Reading strings with spaces") {
+	auto g = gdwg::graph<std::string, std::string>{"hello there", "how", "(", ")"};
+	g.insert_edge("hello there", "how", "a | b");
+	g.insert_edge("hello there", ")", " ");
+	g.insert_edge("(", "hello there", "");
+	auto out = std::ostringstream{};
+	out << g;
+
+	auto in = std::istringstream(out.str());
+	auto read = gdwg::graph<std::string, std::string>(gdwg::in_edge_index::disabled);
+	in >> read;
+	CHECK(read == g);
+	CHECK(!read.in_edges_indexed());
+}
+
+TEST_CASE("Reading adds destinations before their own block") {
+	auto in = std::istringstream("1 (\n  2 | 5\n)\n");
+	auto const g = gdwg::read_graph<int, int>(in);
+	CHECK(g.nodes() == std::vector<int>{1, 2});
+	CHECK(g.weights(1, 2) == std::vector<int>{5});
+}
+
+TEST_CASE("Reading an empty input") {
+	auto in = std::istringstream("");
+	CHECK(gdwg::read_graph<int, int>(in).empty());
+}
+
+TEST_CASE("Reading malformed input reports the line") {
+	auto g = gdwg::graph<int, int>{1, 2};
+	g.insert_edge(1, 2, 3);
+	auto const expected = g;
+
+	auto const check = [&](std::string const& text, std::size_t line, std::string const& message) {
+		auto in = std::istringstream(text);
+		try {
+			in >> g;
+			FAIL("expected a parse_error");
+		} catch (gdwg::parse_error const& error) {
+			CHECK(error.line() == line);
+			CHECK(error.what() == message);
+		}
+		CHECK(g == expected);
+	};
+	check("1 (\n  2 | x\n)\n",
+	      2,
+	      "Cannot read a gdwg::graph<N, E>: line 2: cannot parse the edge's weight");
+	check("1 (\n  two | 3\n)\n",
+	      2,
+	      "Cannot read a gdwg::graph<N, E>: line 2: cannot parse the edge's destination");
+	check("1 (\n)\n1\n",
+	      3,
+	      "Cannot read a gdwg::graph<N, E>: line 3: expected a node followed by \" (\"");
+	check("x (\n)\n", 1, "Cannot read a gdwg::graph<N, E>: line 1: cannot parse the node");
+	check("1 (\n2 | 3\n)\n",
+	      2,
+	      "Cannot read a gdwg::graph<N, E>: line 2: expected \"  dst | weight\" or \")\"");
+	check("1 (\n  2 | 3\n",
+	      2,
+	      "Cannot read a gdwg::graph<N, E>: line 2: expected \")\" before the end of the input");
+}
+
+TEST_CASE("Reading lines longer than a block") {
+	auto const long_value = std::string(200000, 'x');
+	auto g = gdwg::graph<std::string, int>{long_value, "y"};
+	g.insert_edge("y", long_value, 1);
+	g.insert_edge(long_value, "y", 2);
+	auto out = std::ostringstream{};
+	out << g;
+
+	auto in = std::istringstream(out.str());
+	CHECK(gdwg::read_graph<std::string, int>(in) == g);
+}
+
+TEST_CASE("Output matches the stream's formatting") {
+	auto g = gdwg::graph<int, double>{-1, 10, 300};
+	g.insert_edge(-1, 10, 3.14159265);
+	g.insert_edge(10, 300, 1e-7);
+	g.insert_edge(300, -1, 2.5e12);
+	g.insert_edge(300, 300, 100);
+
+	auto const per_value = [&g](auto const& configure) {
+		auto out = std::ostringstream{};
+		configure(out);
+		for (auto const& node : g.nodes()) {
+			out << node << " (\n";
+			for (auto const& edge : g.out_edges(node)) {
+				out << "  " << edge.to << " | " << edge.weight << "\n";
+			}
+			out << ")\n";
+		}
+		return out.str();
+	};
+	auto const streamed = [&g](auto const& configure) {
+		auto out = std::ostringstream{};
+		configure(out);
+		out << g;
+		return out.str();
+	};
+
+	auto const configurations = std::vector<std::function<void(std::ostream&)>>{
+	   [](std::ostream&) {},
+	   [](std::ostream& os) { os.precision(12); },
+	   [](std::ostream& os) { os << std::fixed; },
+	   [](std::ostream& os) { os << std::hex << std::showpos; },
+	};
+	for (auto const& configure : configurations) {
+		CHECK(streamed(configure) == per_value(configure));
+	}
+}
+
+TEST_CASE("Dumping to a string, a sink or a file descriptor") {
+	auto g = gdwg::graph<std::string, double>{"hello", "how", "are"};
+	g.insert_edge("hello", "how", 0.1);
+	g.insert_edge("hello", "are", 1.0 / 3);
+	g.insert_edge("are", "are", -7);
+	auto expected = std::ostringstream{};
+	expected << g;
+
+	auto out = std::string("prefix\n");
+	dump(g, out);
+	CHECK(out == "prefix\n" + expected.str());
+
+	auto chunks = std::string();
+	dump(g, [&chunks](std::string_view chunk) { chunks.append(chunk); });
+	CHECK(chunks == expected.str());
+
+	auto fds = std::array<int, 2>{};
+	REQUIRE(::pipe(fds.data()) == 0);
+	dump(g, fds[1]);
+	::close(fds[1]);
+	auto read = std::string();
+	auto chunk = std::array<char, 256>{};
+	for (auto n = ::read(fds[0], chunk.data(), chunk.size()); n > 0;
+	     n = ::read(fds[0], chunk.data(), chunk.size()))
+	{
+		read.append(chunk.data(), static_cast<std::size_t>(n));
+	}
+	::close(fds[0]);
+	CHECK(read == expected.str());
+
+	CHECK_THROWS_AS(dump(g, -1), std::system_error);
+}
+
+TEST_CASE("Output longer than a chunk") {
+	auto g = gdwg::graph<int, int>{};
+	for (auto i = 0; i < 5000; ++i) {
+		g.insert_node(i);
+	}
+	for (auto i = 0; i < 5000; ++i) {
+		g.insert_edge(i, (i * 7) % 5000, i);
+		g.insert_edge(i, (i * 13) % 5000, -i);
+	}
+	auto out = std::ostringstream{};
+	out << g;
+	auto in = std::istringstream(out.str());
+	CHECK(gdwg::read_graph<int, int>(in) == g);
+
+	auto dumped = std::string();
+	dump(g, dumped);
+	CHECK(dumped == out.str());
+}
+
+TEST_CASE("Replacing and merging nodes keeps every view consistent") {
+	for (auto index : {gdwg::in_edge_index::enabled, gdwg::in_edge_index::disabled}) {
+		auto g = gdwg::graph<int, int>(index);
+		auto expected = gdwg::graph<int, int>(index);
+		for (auto i = 0; i < 20; ++i) {
+			g.insert_node(i);
+		}
+		for (auto i = 0; i < 120; ++i) {
+			g.insert_edge(i % 20, i * 7 % 20, i % 3);
+		}
+		g.insert_edge(5, 5, 1);
+
+		// The expected graph is built from scratch with the nodes already renamed.
+		auto const rename = [](int value) { return value == 5 ? 25 : value == 7 ? 3 : value; };
+		for (auto i = 0; i < 20; ++i) {
+			expected.insert_node(rename(i));
+		}
+		for (auto const& edge : g) {
+			expected.insert_edge(rename(edge.from), rename(edge.to), edge.weight);
+		}
+		expected.erase_node(7);
+
+		CHECK(g.replace_node(5, 25));
+		g.merge_replace_node(7, 3);
+		CHECK(g == expected);
+		for (auto const node : expected.nodes()) {
+			CHECK(std::ranges::distance(g.out_edges(node))
+			      == std::ranges::distance(expected.out_edges(node)));
+			CHECK(g.predecessors(node) == expected.predecessors(node));
+			CHECK(g.in_degree(node) == expected.in_degree(node));
+			CHECK(g.connections(node) == expected.connections(node));
+		}
+		CHECK(!g.replace_node(25, 3));
+	}
+}
+
+TEST_CASE("Replacing a node reuses its edges' storage") {
+	auto resource = counting_resource{};
+	auto g = gdwg::pmr::graph<int, int>({1, 2, 3}, &resource);
+	for (auto weight = 0; weight < 16; ++weight) {
+		g.insert_edge(1, 2, weight);
+		g.insert_edge(3, 1, weight);
+	}
+
+	auto const before = resource.allocations;
+	g.replace_node(1, 4);
+	CHECK(resource.allocations == before);
+	// At most one allocation, to record the merged node's id as free.
+	g.merge_replace_node(4, 2);
+	CHECK(resource.allocations <= before + 1);
+	CHECK(g.weights(2, 2).size() == 16);
+	CHECK(g.weights(3, 2).size() == 16);
+}
+
+TEST_CASE("Hashed lookup answers like ordered lookup") {
+	auto ordered = gdwg::graph<std::string, int>();
+	auto hashed = gdwg::graph<std::string, int>(gdwg::node_lookup::hashed);
+	CHECK(hashed.lookup() == gdwg::node_lookup::hashed);
+	CHECK(ordered.lookup() == gdwg::node_lookup::ordered);
+
+	auto const name = [](int i) { return "node " + std::to_string(i); };
+	auto const check_same = [&] {
+		REQUIRE(hashed == ordered);
+		for (auto i = 0; i < 40; ++i) {
+			CHECK(hashed.is_node(name(i)) == ordered.is_node(name(i)));
+			if (!ordered.is_node(name(i))) {
+				continue;
+			}
+			CHECK(hashed.connections(name(i)) == ordered.connections(name(i)));
+			for (auto j = 0; j < 40; j += 3) {
+				if (ordered.is_node(name(j))) {
+					CHECK(hashed.is_connected(name(i), name(j)) == ordered.is_connected(name(i), name(j)));
+					CHECK(hashed.weights(name(i), name(j)) == ordered.weights(name(i), name(j)));
+					CHECK(std::ranges::distance(hashed.edges_between(name(i), name(j)))
+					      == std::ranges::distance(ordered.edges_between(name(i), name(j))));
+				}
+			}
+		}
+	};
+
+	for (auto* g : {&ordered, &hashed}) {
+		for (auto i = 0; i < 30; ++i) {
+			g->insert_node(name(i));
+		}
+		for (auto i = 0; i < 600; ++i) {
+			g->insert_edge(name(i % 30), name(i * 7 % 30), i % 4);
+		}
+	}
+	check_same();
+
+	for (auto* g : {&ordered, &hashed}) {
+		for (auto i = 0; i < 600; i += 5) {
+			g->erase_edge(name(i % 30), name(i * 7 % 30), i % 4);
+		}
+		g->erase_node(name(3));
+		g->replace_node(name(4), name(34));
+		g->merge_replace_node(name(5), name(6));
+		g->batch().insert_node(name(35)).insert_edge(name(35), name(6), 1).erase_node(name(7)).commit();
+	}
+	check_same();
+
+	auto copy = hashed;
+	CHECK(copy.lookup() == gdwg::node_lookup::hashed);
+	auto moved = std::move(copy);
+	moved.insert_edge(name(35), name(34), 2);
+	ordered.insert_edge(name(35), name(34), 2);
+	hashed = moved;
+	check_same();
+
+	auto out = std::ostringstream();
+	out << hashed;
+	auto in = std::istringstream(out.str());
+	in >> hashed;
+	CHECK(hashed.lookup() == gdwg::node_lookup::hashed);
+	check_same();
+
+	hashed.clear();
+	CHECK(!hashed.is_node(name(1)));
+	hashed.insert_node(name(1));
+	CHECK(hashed.is_node(name(1)));
+}
+
+TEST_CASE("Hashed lookup with many nodes coming and going") {
+	auto g = gdwg::graph<int, int>(gdwg::in_edge_index::disabled, gdwg::node_lookup::hashed);
+	for (auto round = 0; round < 4; ++round) {
+		for (auto i = 0; i < 2000; ++i) {
+			g.insert_node(i * 64);
+		}
+		for (auto i = 0; i < 2000; i += 2) {
+			g.erase_node(i * 64);
+		}
+		for (auto i = 0; i < 2000; ++i) {
+			CHECK(g.is_node(i * 64) == (i % 2 == 1));
+		}
+		g.clear();
+	}
+}
+
+TEST_CASE("Hashed lookup tables use the graph's allocator") {
+	auto resource = counting_resource{};
+	{
+		auto g = gdwg::pmr::graph<int, int>(gdwg::node_lookup::hashed, &resource);
+		g.insert_node(1);
+		g.insert_node(2);
+		g.insert_edge(1, 2, 3);
+		auto const before = resource.allocations;
+		auto copy = gdwg::pmr::graph<int, int>(g, &resource);
+		CHECK(resource.allocations > before);
+		CHECK(copy.is_connected(1, 2));
+		CHECK(copy.lookup() == gdwg::node_lookup::hashed);
+	}
+	CHECK(resource.outstanding == 0);
+}
@@ -0,0 +1,113 @@
+#include "gdwg/parallel_build.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+	using edge = gdwg::graph<int, int>::value_type;
+
+	// `count` random edges between nodes 0 to `n - 1`, with plenty of repeats.
+	auto make_edges(int n, std::size_t count) -> std::vector<edge> {
+		auto rng = std::mt19937(6771);
+		auto node = std::uniform_int_distribution<int>(0, n - 1);
+		auto weight = std::uniform_int_distribution<int>(0, 3);
+		auto edges = std::vector<edge>();
+		for (auto i = std::size_t{0}; i < count; ++i) {
+			edges.push_back(edge{node(rng), node(rng), weight(rng)});
+		}
+		return edges;
+	}
+
+	auto make_nodes(int n) -> std::vector<int> {
+		auto nodes = std::vector<int>();
+		for (auto i = 0; i < n; ++i) {
+			nodes.push_back(i);
+		}
+		return nodes;
+	}
+} // namespace
+
+TEST_CASE("Parallel inserts match a sequential insert") {
+	auto const nodes = make_nodes(500);
+	auto const edges = make_edges(500, 20000);
+	auto expected = gdwg::graph<int, int>(nodes.begin(), nodes.end());
+	auto const expected_count = expected.insert_edges(edges.begin(), edges.end());
+
+	for (auto threads : {1U, 2U, 3U, 4U, 7U}) {
+		auto g = gdwg::graph<int, int>(nodes.begin(), nodes.end());
+		CHECK(gdwg::insert_edges(g, edges.begin(), edges.end(), {.threads = threads})
+		      == expected_count);
+		CHECK(g == expected);
+		CHECK(g.predecessors(0) == expected.predecessors(0));
+		CHECK(g.in_degree(499) == expected.in_degree(499));
+	}
+}
+
+TEST_CASE("Parallel inserts add to the edges already in the graph") {
+	auto const nodes = make_nodes(300);
+	auto const edges = make_edges(300, 8000);
+
+	for (auto lookup : {gdwg::node_lookup::ordered, gdwg::node_lookup::hashed}) {
+		auto expected = gdwg::graph<int, int>(lookup);
+		auto g = gdwg::graph<int, int>(lookup);
+		for (auto node : nodes) {
+			expected.insert_node(node);
+			g.insert_node(node);
+		}
+		// Erased nodes leave unused ids behind, so ids aren't the same as ranks.
+		for (auto node = 0; node < 300; node += 7) {
+			expected.erase_node(node);
+			g.erase_node(node);
+		}
+		auto present = std::vector<edge>();
+		for (auto const& e : edges) {
+			if (g.is_node(e.from) && g.is_node(e.to)) {
+				present.push_back(e);
+			}
+		}
+
+		auto const middle = present.begin() + static_cast<std::ptrdiff_t>(present.size() / 2);
+		expected.insert_edges(present.begin(), present.end());
+		g.insert_edges(present.begin(), middle);
+		gdwg::insert_edges(g, present.begin(), present.end(), {.threads = 4});
+		CHECK(g == expected);
+		CHECK(gdwg::insert_edges(g, present.begin(), present.end(), {.threads = 4}) == 0);
+
+		g.erase_node(1);
+		expected.erase_node(1);
+		CHECK(g == expected);
+		CHECK(g.is_connected(2, 3) == expected.is_connected(2, 3));
+	}
+}
+
+TEST_CASE("Parallel inserts with a missing endpoint insert nothing") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.insert_edge("a", "b", 1);
+	auto const before = g;
+
+	auto edges = std::vector<gdwg::graph<std::string, int>::value_type>();
+	for (auto i = 0; i < 1000; ++i) {
+		edges.push_back({"a", "c", i});
+	}
+	edges.push_back({"c", "z", 1});
+	CHECK_THROWS_WITH(gdwg::insert_edges(g, edges.begin(), edges.end(), {.threads = 3}),
+	                  "Cannot call gdwg::insert_edges when either src or dst node does not exist");
+	CHECK(g == before);
+}
+
+TEST_CASE("Small parallel inserts") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	auto const edges = std::vector<gdwg::graph<std::string, int>::value_type>{{"b", "a", 1},
+	                                                                          {"a", "c", 2},
+	                                                                          {"b", "a", 1}};
+	CHECK(gdwg::insert_edges(g, edges.begin(), edges.end()) == 2);
+	CHECK(gdwg::insert_edges(g, edges.begin(), edges.end(), {.threads = 8}) == 0);
+	CHECK(g.is_connected("b", "a"));
+	CHECK(g.weights("a", "c") == std::vector<int>{2});
+
+	auto empty = std::vector<gdwg::graph<std::string, int>::value_type>();
+	CHECK(gdwg::insert_edges(g, empty.begin(), empty.end(), {.threads = 4}) == 0);
+}